@@ -0,0 +1,97 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+/* such software.  many freedoms. */
+
+/* a few MB of records.  three fields out of it: parse it all and fetch, or
+ * fetch straight from the text */
+
+#include <cdson.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define ROUNDS 5
+#define RECORDS 20000
+
+static const char *queries[] = {
+    ".meta.version", ".records[10000].name", ".records[19999].tags[1]",
+};
+#define N_QUERIES (sizeof(queries) / sizeof(*queries))
+
+static double now(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* such "meta" is such ... wow, "records" is so such "id" is ..., "name"
+ * is ..., "tags" is so ... many wow and ... many wow */
+static char *records(size_t n, size_t *len_out) {
+    char *s;
+    size_t len = 0;
+
+    s = malloc(n * 0200 + 0200);
+    if (s == NULL)
+        exit(1);
+    len += sprintf(s, "such \"meta\" is such \"version\" is 3, \"by\" is "
+                   "\"doge\" wow, \"records\" is so ");
+    for (size_t i = 0; i < n; i++) {
+        len += sprintf(s + len, "such \"id\" is %zo, \"name\" is "
+                       "\"shibe%zu\", \"tags\" is so \"a\" and \"b\\n\" "
+                       "many, \"score\" is %zo.4 wow %s ", i, i, i % 0100,
+                       i + 1 < n ? "and" : "many wow");
+    }
+    *len_out = len;
+    return s;
+}
+
+int main() {
+    dson_value *tree, *got;
+    char *input, *err;
+    size_t len;
+    double start, best_parse = -1, best_text = -1;
+
+    input = records(RECORDS, &len);
+
+    for (int r = 0; r < ROUNDS; r++) {
+        start = now();
+        err = dson_parse(input, len, false, &tree);
+        for (size_t i = 0; err == NULL && i < N_QUERIES; i++)
+            err = dson_fetch(tree, queries[i], DSON_MATCH_FIRST, &got);
+        if (err != NULL) {
+            fprintf(stderr, "parse and fetch failure: %s\n", err);
+            exit(1);
+        }
+        dson_free(&tree);
+        start = now() - start;
+        if (best_parse < 0 || start < best_parse)
+            best_parse = start;
+
+        start = now();
+        for (size_t i = 0; i < N_QUERIES; i++) {
+            err = dson_fetch_text(input, len, NULL, queries[i],
+                                  DSON_MATCH_FIRST, &got);
+            if (err != NULL) {
+                fprintf(stderr, "fetch from text failure: %s\n", err);
+                exit(1);
+            }
+            dson_free(&got);
+        }
+        start = now() - start;
+        if (best_text < 0 || start < best_text)
+            best_text = start;
+    }
+    free(input);
+
+    printf("%zu fields from %zu bytes: parse and fetch %8.2f ms, from text "
+           "%8.2f ms\n", N_QUERIES, len, best_parse * 1e3, best_text * 1e3);
+    return 0;
+}
+
+/* Local variables: */
+/* c-basic-offset: 4 */
+/* indent-tabs-mode: nil */
+/* End: */
@@ -0,0 +1,168 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+/* such software.  many freedoms. */
+
+/* one very wide dict.  many lookups.  then many fields under one path, one
+ * at a time and all at once */
+
+#include <cdson.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define ROUNDS 5
+#define KEYS 010000
+#define LOOKUPS 0200000
+#define FIELDS 040
+#define BATCHES 010000
+
+static double now(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* such "key0" is 0, "key1" is 1, ... wow */
+static char *wide(size_t n) {
+    char *s;
+    size_t len = 0;
+
+    s = malloc(n * 040 + 16);
+    if (s == NULL)
+        exit(1);
+    len += sprintf(s, "such ");
+    for (size_t i = 0; i < n; i++) {
+        len += sprintf(s + len, "\"key%zo\" is %zo%s ", i, i,
+                       i + 1 < n ? "," : " wow");
+    }
+    return s;
+}
+
+static void run(const char *name, const char *input, bool compact,
+                uint8_t match) {
+    dson_options opts = { 0 };
+    dson_value *v, *got;
+    char *err, query[64];
+    double start, best = -1, sum = 0;
+
+    opts.compact = compact;
+    err = dson_parse_opts(input, strlen(input), &opts, &v);
+    if (err != NULL) {
+        fprintf(stderr, "%s: parse failure: %s\n", name, err);
+        exit(1);
+    }
+
+    for (int r = 0; r < ROUNDS; r++) {
+        start = now();
+        for (size_t i = 0; i < LOOKUPS; i++) {
+            sprintf(query, ".key%zo", i * 7919 % KEYS);
+            err = dson_fetch(v, query, match, &got);
+            if (err != NULL) {
+                fprintf(stderr, "%s: fetch failure: %s\n", name, err);
+                exit(1);
+            }
+            sum += got->n;
+        }
+        start = now() - start;
+        if (best < 0 || start < best)
+            best = start;
+    }
+    dson_free(&v);
+
+    printf("%-8s %-6s %d lookups in %d keys %8.2f ms   (%g)\n", name,
+           match == DSON_MATCH_FIRST ? "first" : match == DSON_MATCH_LAST ?
+           "last" : "error", LOOKUPS, KEYS, best * 1e3, sum);
+}
+
+/* such "x0" is 0, ... "config" is such "y0" is 0, ... "limits" is such
+ * "f0" is 0, ... wow wow wow.  a few neighbours on the way down, as
+ * real configs have */
+#define NEIGHBOURS 014
+static void batch(void) {
+    const char *queries[FIELDS];
+    dson_value *v, *outs[FIELDS];
+    char *input, *err, names[FIELDS][040];
+    size_t len = 0;
+    double start, best_one = -1, best_many = -1, sum = 0;
+
+    input = malloc((FIELDS + NEIGHBOURS * 02) * 040 + 0100);
+    if (input == NULL)
+        exit(1);
+    len += sprintf(input, "such ");
+    for (size_t i = 0; i < NEIGHBOURS; i++)
+        len += sprintf(input + len, "\"x%zo\" is %zo, ", i, i);
+    len += sprintf(input + len, "\"config\" is such ");
+    for (size_t i = 0; i < NEIGHBOURS; i++)
+        len += sprintf(input + len, "\"y%zo\" is %zo, ", i, i);
+    len += sprintf(input + len, "\"limits\" is such ");
+    for (size_t i = 0; i < FIELDS; i++) {
+        len += sprintf(input + len, "\"f%zo\" is %zo%s ", i, i,
+                       i + 1 < FIELDS ? "," : " wow wow wow");
+        sprintf(names[i], ".config.limits.f%zo", i);
+        queries[i] = names[i];
+    }
+    err = dson_parse(input, len, false, &v);
+    free(input);
+    if (err != NULL) {
+        fprintf(stderr, "batch: parse failure: %s\n", err);
+        exit(1);
+    }
+
+    for (int r = 0; r < ROUNDS; r++) {
+        start = now();
+        for (size_t b = 0; b < BATCHES; b++) {
+            for (size_t i = 0; i < FIELDS; i++) {
+                err = dson_fetch(v, queries[i], DSON_MATCH_FIRST, &outs[i]);
+                if (err != NULL) {
+                    fprintf(stderr, "batch: fetch failure: %s\n", err);
+                    exit(1);
+                }
+                sum += outs[i]->n;
+            }
+        }
+        start = now() - start;
+        if (best_one < 0 || start < best_one)
+            best_one = start;
+
+        start = now();
+        for (size_t b = 0; b < BATCHES; b++) {
+            err = dson_fetch_many(v, queries, FIELDS, DSON_MATCH_FIRST, outs,
+                                  NULL);
+            if (err != NULL) {
+                fprintf(stderr, "batch: fetch_many failure: %s\n", err);
+                exit(1);
+            }
+            for (size_t i = 0; i < FIELDS; i++)
+                sum += outs[i]->n;
+        }
+        start = now() - start;
+        if (best_many < 0 || start < best_many)
+            best_many = start;
+    }
+    dson_free(&v);
+
+    printf("%d batches of %d fields: one at a time %8.2f ms, all at once "
+           "%8.2f ms   (%g)\n", BATCHES, FIELDS, best_one * 1e3,
+           best_many * 1e3, sum);
+}
+
+int main() {
+    char *input = wide(KEYS);
+
+    for (uint8_t match = 0; match <= DSON_MATCH_ERROR; match++) {
+        run("plain", input, false, match);
+        run("compact", input, true, match);
+    }
+    free(input);
+
+    batch();
+    return 0;
+}
+
+/* Local variables: */
+/* c-basic-offset: 4 */
+/* indent-tabs-mode: nil */
+/* End: */
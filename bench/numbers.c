@@ -0,0 +1,91 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+/* such software.  many freedoms. */
+
+/* much telemetry.  so numbers.  parse time for number-dense input */
+
+#include <cdson.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define ROUNDS 5
+
+static double now(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* xorshift.  same kibble every run */
+static unsigned long long seed = 88172645463325252ULL;
+static unsigned long long noise(void) {
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    return seed;
+}
+
+static char *samples(size_t n, int kind) {
+    char *s;
+    size_t len = 0;
+    unsigned long long r;
+
+    s = malloc(n * 64 + 16);
+    if (s == NULL)
+        exit(1);
+    len += sprintf(s, "so ");
+    for (size_t i = 0; i < n; i++) {
+        r = noise();
+        if (kind == 0)
+            len += sprintf(s + len, "%llo", r % 01000000);
+        else if (kind == 1)
+            len += sprintf(s + len, "%llo.%llo", r % 010000,
+                           (r >> 20) % 010000000);
+        else
+            len += sprintf(s + len, "-%llo.%llovery-%llo", r % 010,
+                           (r >> 8) % 0100000000000000000ULL,
+                           (r >> 60) % 020);
+        len += sprintf(s + len, " %s ", i + 1 < n ? "and" : "many");
+    }
+    return s;
+}
+
+static void run(const char *name, char *input) {
+    dson_value *v;
+    char *err;
+    size_t len = strlen(input);
+    double start, best = -1;
+
+    for (int r = 0; r < ROUNDS; r++) {
+        start = now();
+        err = dson_parse(input, len, false, &v);
+        if (err != NULL) {
+            fprintf(stderr, "%s: parse failure: %s\n", name, err);
+            exit(1);
+        }
+        dson_free(&v);
+        start = now() - start;
+        if (best < 0 || start < best)
+            best = start;
+    }
+
+    printf("%-16s %10.2f ms %10.2f MB/s\n", name, best * 1e3,
+           len / best / 1e6);
+    free(input);
+}
+
+int main() {
+    run("integers", samples(1000000, 0));
+    run("fractions", samples(1000000, 1));
+    run("exponents", samples(1000000, 2));
+    return 0;
+}
+
+/* Local variables: */
+/* c-basic-offset: 4 */
+/* indent-tabs-mode: nil */
+/* End: */
@@ -0,0 +1,89 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+/* such software.  many freedoms. */
+
+/* much ascii.  many escapes.  string parse and dump throughput */
+
+#include <cdson.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define ROUNDS 5
+
+static double now(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* so "...", and ... many.  ~`width` bytes per string, cycling `phrase` */
+static char *corpus(size_t n, size_t width, const char *phrase) {
+    size_t len = 0, start, p_len = strlen(phrase);
+    char *s;
+
+    s = malloc(n * (width + p_len + 16) + 16);
+    if (s == NULL)
+        exit(1);
+    len += sprintf(s, "so ");
+    for (size_t i = 0; i < n; i++) {
+        s[len++] = '"';
+        for (start = len; len - start < width; len += p_len)
+            memcpy(s + len, phrase, p_len);
+        len += sprintf(s + len, "\" %s ", i + 1 < n ? "and" : "many");
+    }
+    s[len] = '\0';
+    return s;
+}
+
+static void run(const char *name, char *input) {
+    dson_value *v;
+    char *err, *out;
+    size_t len = strlen(input), out_len;
+    double start, best_p = -1, best_d = -1;
+
+    for (int r = 0; r < ROUNDS; r++) {
+        start = now();
+        err = dson_parse(input, len, false, &v);
+        if (err != NULL) {
+            fprintf(stderr, "%s: parse failure: %s\n", name, err);
+            exit(1);
+        }
+        start = now() - start;
+        if (best_p < 0 || start < best_p)
+            best_p = start;
+
+        start = now();
+        err = dson_dump(v, &out, &out_len);
+        if (err != NULL) {
+            fprintf(stderr, "%s: dump failure: %s\n", name, err);
+            exit(1);
+        }
+        start = now() - start;
+        if (best_d < 0 || start < best_d)
+            best_d = start;
+
+        free(out);
+        dson_free(&v);
+    }
+
+    printf("%-20s parse %8.2f MB/s   dump %8.2f MB/s\n", name,
+           len / best_p / 1e6, len / best_d / 1e6);
+    free(input);
+}
+
+int main() {
+    run("ascii short (16)", corpus(400000, 16, "such doge wow "));
+    run("ascii long (4096)", corpus(4000, 4096, "such doge wow "));
+    run("escapes (128)", corpus(100000, 128, "a\\/b\\\"c\\nd\\\\"));
+    run("mixed (128)", corpus(100000, 128, "path\\/to\\/doge.txt\\t"));
+    return 0;
+}
+
+/* Local variables: */
+/* c-basic-offset: 4 */
+/* indent-tabs-mode: nil */
+/* End: */
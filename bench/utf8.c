@@ -0,0 +1,107 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+/* such software.  many freedoms. */
+
+/* many scripts.  such text.  string parse and dump throughput */
+
+#include <cdson.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define ROUNDS 5
+
+static double now(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static const char *phrases[] = {
+    "\xe6\x9f\xb4\xe7\x8a\xac\xe3\x81\xaf\xe3\x81\xa8\xe3\x81\xa6\xe3\x82"
+    "\x82\xe5\x8f\xaf\xe6\x84\x9b\xe3\x81\x84\xe3\x80\x82",
+    "\xe7\x8b\x97\xe7\x8b\x97\xe5\xbe\x88\xe9\xab\x98\xe5\x85\xb4",
+    "\xed\x95\x9c\xea\xb5\xad\xec\x96\xb4 \xeb\xac\xb8\xec\x9e\xa5",
+    "\xd1\x81\xd0\xbe\xd0\xb1\xd0\xb0\xd0\xba\xd0\xb0 ",
+    "such doge, very text ",
+    "\xf0\x9f\x90\x95\xf0\x9f\x90\xb6",
+};
+
+/* so "...", and ... many.  ~`width` bytes per string */
+static char *corpus(size_t n, size_t width) {
+    char *s;
+    size_t len = 0, start;
+
+    s = malloc(n * (width + 64) + 16);
+    if (s == NULL)
+        exit(1);
+    len += sprintf(s, "so ");
+    for (size_t i = 0; i < n; i++) {
+        s[len++] = '"';
+        start = len;
+        for (size_t j = i; len - start < width; j++) {
+            const char *p = phrases[j % 6];
+            memcpy(s + len, p, strlen(p));
+            len += strlen(p);
+        }
+        len += sprintf(s + len, "\" %s ", i + 1 < n ? "and" : "many");
+    }
+    s[len] = '\0';
+    return s;
+}
+
+static void run(const char *name, char *input) {
+    dson_value *v;
+    char *err, *out;
+    size_t len = strlen(input), out_len;
+    double start, best_v = -1, best_d = -1;
+
+    err = dson_parse(input, len, false, &v);
+    if (err != NULL) {
+        fprintf(stderr, "%s: parse failure: %s\n", name, err);
+        exit(1);
+    }
+
+    for (int r = 0; r < ROUNDS; r++) {
+        start = now();
+        err = dson_validate(input, len, NULL);
+        if (err != NULL) {
+            fprintf(stderr, "%s: validate failure: %s\n", name, err);
+            exit(1);
+        }
+        start = now() - start;
+        if (best_v < 0 || start < best_v)
+            best_v = start;
+
+        start = now();
+        err = dson_dump(v, &out, &out_len);
+        if (err != NULL) {
+            fprintf(stderr, "%s: dump failure: %s\n", name, err);
+            exit(1);
+        }
+        free(out);
+        start = now() - start;
+        if (best_d < 0 || start < best_d)
+            best_d = start;
+    }
+
+    printf("%-16s validate %8.2f MB/s   dump %8.2f MB/s\n", name,
+           len / best_v / 1e6, len / best_d / 1e6);
+    dson_free(&v);
+    free(input);
+}
+
+int main() {
+    run("short (16)", corpus(400000, 16));
+    run("medium (128)", corpus(100000, 128));
+    run("long (4096)", corpus(4000, 4096));
+    return 0;
+}
+
+/* Local variables: */
+/* c-basic-offset: 4 */
+/* indent-tabs-mode: nil */
+/* End: */
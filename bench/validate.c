@@ -0,0 +1,94 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+/* such software.  many freedoms. */
+
+/* much gatekeeping.  validate throughput next to a full parse */
+
+#include <cdson.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define ROUNDS 5
+
+static double now(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* a bit of everything.  such records */
+static char *records(size_t n) {
+    char *s;
+    size_t len = 0;
+
+    s = malloc(n * 160 + 16);
+    if (s == NULL)
+        exit(1);
+    len += sprintf(s, "so\n");
+    for (size_t i = 0; i < n; i++) {
+        len += sprintf(s + len,
+                       "    such \"id\" is %zo, \"name\" is \"shibe %zu\", "
+                       "\"good\" is yes, \"bark\" is \"wo\\nof\", "
+                       "\"weight\" is 17.4very2, \"toys\" is so \"ball\" "
+                       "and empty many wow %s\n",
+                       i, i, i + 1 < n ? "and" : "many");
+    }
+    return s;
+}
+
+static void parse_free(const char *input, size_t len) {
+    dson_value *v;
+    char *err;
+
+    err = dson_parse(input, len, false, &v);
+    if (err != NULL) {
+        fprintf(stderr, "parse failure: %s\n", err);
+        exit(1);
+    }
+    dson_free(&v);
+}
+
+static void validate(const char *input, size_t len) {
+    char *err;
+
+    err = dson_validate(input, len, NULL);
+    if (err != NULL) {
+        fprintf(stderr, "validate failure: %s\n", err);
+        exit(1);
+    }
+}
+
+static void run(const char *name, const char *input,
+                void (*fn)(const char *, size_t)) {
+    size_t len = strlen(input);
+    double start, best = -1;
+
+    for (int r = 0; r < ROUNDS; r++) {
+        start = now();
+        fn(input, len);
+        start = now() - start;
+        if (best < 0 || start < best)
+            best = start;
+    }
+
+    printf("%-16s %10.2f ms %10.2f MB/s\n", name, best * 1e3,
+           len / best / 1e6);
+}
+
+int main() {
+    char *input = records(100000);
+
+    run("parse+free", input, parse_free);
+    run("validate", input, validate);
+    free(input);
+    return 0;
+}
+
+/* Local variables: */
+/* c-basic-offset: 4 */
+/* indent-tabs-mode: nil */
+/* End: */
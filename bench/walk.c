@@ -0,0 +1,158 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+/* such software.  many freedoms. */
+
+/* much tree.  such walk.  plain layout against compact, with and without
+ * inline strings */
+
+#include <cdson.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define ROUNDS 5
+#define RECORDS 200000
+#define FETCHES 10000
+
+static double now(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* so such "id" is ..., "name" is ..., "tags" is so ... many wow and ... */
+static char *records(size_t n) {
+    char *s;
+    size_t len = 0;
+
+    s = malloc(n * 0200 + 16);
+    if (s == NULL)
+        exit(1);
+    len += sprintf(s, "so ");
+    for (size_t i = 0; i < n; i++) {
+        len += sprintf(s + len, "such \"id\" is %zo, \"name\" is \"shibe%zu\", "
+                       "\"tags\" is so \"a\" and \"b\" many, \"score\" is "
+                       "%zo.4 wow %s ", i, i, i % 0100, i + 1 < n ? "and" :
+                       "many");
+    }
+    return s;
+}
+
+/* every node.  sum what can be summed, and how long strings are */
+static double walk(dson_value *v) {
+    double sum = 0;
+
+    if (v->type == DSON_DOUBLE) {
+        return v->n;
+    } else if ((v->type & ~DSON_INLINE) == DSON_STRING) {
+        return dson_str_len(v);
+    } else if (v->type == DSON_ARRAY) {
+        for (size_t i = 0; v->array[i] != NULL; i++)
+            sum += walk(v->array[i]);
+    } else if (v->type == DSON_DICT) {
+        for (size_t i = 0; v->dict->keys[i] != NULL; i++)
+            sum += walk(v->dict->values[i]);
+    } else if (v->type == DSON_LIST) {
+        for (size_t i = 0; i < v->list->len; i++)
+            sum += walk(&v->list->items[i]);
+    } else if (v->type == DSON_TABLE) {
+        for (size_t i = 0; i < v->table->len; i++)
+            sum += walk(&v->table->entries[i].value);
+    }
+    return sum;
+}
+
+static void run(const char *name, const char *input, bool compact,
+                bool inline_strings) {
+    dson_options opts = { 0 };
+    dson_value *v, *got;
+    dson_query *queries[FETCHES];
+    const char *failure;
+    char *err, query[64];
+    size_t len = strlen(input);
+    double start, best_p = -1, best_w = -1, best_f = -1, best_q = -1;
+    double sum = 0;
+
+    opts.compact = compact;
+    opts.inline_strings = inline_strings;
+    for (size_t i = 0; i < FETCHES; i++) {
+        sprintf(query, "[%zu].score", i * 7919 % RECORDS);
+        err = dson_query_compile(query, &queries[i]);
+        if (err != NULL) {
+            fprintf(stderr, "%s: compile failure: %s\n", name, err);
+            exit(1);
+        }
+    }
+
+    for (int r = 0; r < ROUNDS; r++) {
+        start = now();
+        err = dson_parse_opts(input, len, &opts, &v);
+        if (err != NULL) {
+            fprintf(stderr, "%s: parse failure: %s\n", name, err);
+            exit(1);
+        }
+        start = now() - start;
+        if (best_p < 0 || start < best_p)
+            best_p = start;
+
+        start = now();
+        sum += walk(v);
+        start = now() - start;
+        if (best_w < 0 || start < best_w)
+            best_w = start;
+
+        start = now();
+        for (size_t i = 0; i < FETCHES; i++) {
+            sprintf(query, "[%zu].score", i * 7919 % RECORDS);
+            err = dson_fetch(v, query, DSON_MATCH_FIRST, &got);
+            if (err != NULL) {
+                fprintf(stderr, "%s: fetch failure: %s\n", name, err);
+                exit(1);
+            }
+            sum += got->n;
+        }
+        start = now() - start;
+        if (best_f < 0 || start < best_f)
+            best_f = start;
+
+        start = now();
+        for (size_t i = 0; i < FETCHES; i++) {
+            failure = dson_query_exec(queries[i], v, DSON_MATCH_FIRST, &got);
+            if (failure != NULL) {
+                fprintf(stderr, "%s: exec failure: %s\n", name, failure);
+                exit(1);
+            }
+            sum += got->n;
+        }
+        start = now() - start;
+        if (best_q < 0 || start < best_q)
+            best_q = start;
+
+        dson_free(&v);
+    }
+
+    for (size_t i = 0; i < FETCHES; i++)
+        dson_query_free(&queries[i]);
+
+    printf("%-8s parse %8.2f ms   walk %8.2f ms   %d fetches %8.2f ms"
+           "   compiled %8.2f ms   (%g)\n", name, best_p * 1e3, best_w * 1e3,
+           FETCHES, best_f * 1e3, best_q * 1e3, sum);
+}
+
+int main() {
+    char *input = records(RECORDS);
+
+    run("plain", input, false, false);
+    run("compact", input, true, false);
+    run("inline", input, true, true);
+    free(input);
+    return 0;
+}
+
+/* Local variables: */
+/* c-basic-offset: 4 */
+/* indent-tabs-mode: nil */
+/* End: */
@@ -0,0 +1,87 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+/* such software.  many freedoms. */
+
+/* very wide.  much elements.  parse time for flat arrays and dicts */
+
+#include <cdson.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define ROUNDS 5
+
+static double now(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static char *wide_array(size_t n) {
+    char *s;
+    size_t len = 0;
+
+    s = malloc(n * 16 + 16);
+    if (s == NULL)
+        exit(1);
+    len += sprintf(s, "so ");
+    for (size_t i = 0; i < n; i++)
+        len += sprintf(s + len, "%zo %s ", i, i + 1 < n ? "and" : "many");
+    return s;
+}
+
+static char *wide_dict(size_t n) {
+    char *s;
+    size_t len = 0;
+
+    s = malloc(n * 32 + 16);
+    if (s == NULL)
+        exit(1);
+    len += sprintf(s, "such ");
+    for (size_t i = 0; i < n; i++)
+        len += sprintf(s + len, "\"k%zu\" is %zo%s ", i, i,
+                       i + 1 < n ? "," : " wow");
+    return s;
+}
+
+static void run(const char *name, char *input) {
+    dson_value *v;
+    char *err;
+    size_t len = strlen(input);
+    double start, best = -1;
+
+    for (int r = 0; r < ROUNDS; r++) {
+        start = now();
+        err = dson_parse(input, len, false, &v);
+        if (err != NULL) {
+            fprintf(stderr, "%s: parse failure: %s\n", name, err);
+            exit(1);
+        }
+        dson_free(&v);
+        start = now() - start;
+        if (best < 0 || start < best)
+            best = start;
+    }
+
+    printf("%-16s %10.2f ms %10.2f MB/s\n", name, best * 1e3,
+           len / best / 1e6);
+    free(input);
+}
+
+int main() {
+    run("array 1k", wide_array(1000));
+    run("array 100k", wide_array(100000));
+    run("array 1M", wide_array(1000000));
+    run("dict 1k", wide_dict(1000));
+    run("dict 100k", wide_dict(100000));
+    run("dict 1M", wide_dict(1000000));
+    return 0;
+}
+
+/* Local variables: */
+/* c-basic-offset: 4 */
+/* indent-tabs-mode: nil */
+/* End: */
@@ -23,7 +23,17 @@ extern "C" {
 #define DSON_STRING 3
 #define DSON_ARRAY 4
 #define DSON_DICT 5
-typedef uint8_t dson_type; /* Can take only the above values. */
+#define DSON_INT 6 /* only when asked for; see dson_options */
+#define DSON_DOUBLE_ARRAY 7 /* only when asked for; see dson_options */
+#define DSON_LIST 8 /* compact array; only when asked for */
+#define DSON_TABLE 9 /* compact dict; only when asked for */
+typedef uint8_t dson_type; /* Can take only the above values, or
+                            * DSON_STRING | DSON_INLINE. */
+
+/* Flag on DSON_STRING: the string is stored in the dson_value itself, not
+ * behind s.  Only when asked for, and only for strings of at most
+ * DSON_INLINE_MAX (7) bytes; see dson_options and dson_str(). */
+#define DSON_INLINE 0200
 
 /* Dictionary type.  Arrays are NULL-terminated.  dson_dicts created by
  * dson_parse() will be valid, \0-terminated UTF-8. */
@@ -32,21 +42,91 @@ typedef struct dson_dict {
     struct dson_value **values;
 } dson_dict;
 
+/* Packed array of numbers: n[0] through n[len - 1], contiguous, with no
+ * dson_value per element.  len is never 0. */
+typedef struct dson_doubles {
+    size_t len;
+    double *n;
+    struct dson_value **boxes; /* made by dson_fetch(); leave alone */
+    struct dson_arena *arena; /* where boxes come from; leave alone */
+} dson_doubles;
+
 /* A parsed tree. */
 typedef struct dson_value {
     dson_type type;
     union {
         bool b;
         double n;
+        int64_t i;
         char *s; /* string - valid, \0-terminated UTF-8. */
         struct dson_value **array;
         dson_dict *dict;
+        dson_doubles *doubles;
+        struct dson_list *list;
+        struct dson_table *table;
+        char tiny[010]; /* inline string; see dson_str() */
     };
 } dson_value;
 
-/* Parse DSON from a NUL-terminated UTF-8 stream.  length does not include the
- * trailing '\0' (it behaves like strlen()).  Returns NULL success, or an error
- * message on failure.  Pass error message to free().
+/* The compact layout, for trees parsed with dson_options.compact set.  A
+ * container is one block: its children sit right inside it as dson_values,
+ * not pointers, after a count, and items (or entries) points at the first
+ * of them.  Nested containers point to their own blocks.  Nothing is
+ * NULL-terminated.  dson_free() frees only the block, so a container built
+ * by hand must keep its children in the same allocation, as the parser
+ * does. */
+typedef struct dson_list {
+    size_t len;
+    dson_value *items;
+} dson_list;
+
+typedef struct dson_entry {
+    dson_value key; /* DSON_STRING, perhaps with DSON_INLINE */
+    dson_value value;
+} dson_entry;
+
+typedef struct dson_table {
+    size_t len;
+    struct dson_index *index; /* made by dson_fetch(); leave alone, or NULL */
+    struct dson_arena *arena; /* where index comes from; leave alone */
+    dson_entry *entries;
+} dson_table;
+
+/* Strings of up to DSON_INLINE_MAX bytes parsed with
+ * dson_options.inline_strings set are stored inside their dson_value, in
+ * tiny, with no allocation of their own.  Their type is
+ * DSON_STRING | DSON_INLINE, and s is not valid.  dson_str() gives the
+ * \0-terminated UTF-8 of either kind of string (or of a DSON_TABLE key),
+ * and dson_str_len() its length in bytes, which is always
+ * strlen(dson_str(v)); for inline strings it is stored, so costs nothing.
+ * As with s, a string is cut short at a decoded \0, so strings holding one
+ * are never inlined.  The pointer is only valid while v is, and moves with
+ * it.
+ *
+ * The room is the union's 8 bytes, less one for the \0, so longer tags and
+ * ids still get an allocation of their own.  Keys are only ever inlined in
+ * a DSON_TABLE, whose keys are dson_values; DSON_DICT keys are always
+ * char *, so dson_fetch() gains from inline keys only in compact trees. */
+#define DSON_INLINE_MAX (sizeof(((dson_value *)0)->tiny) - 01)
+const char *dson_str(const dson_value *v);
+size_t dson_str_len(const dson_value *v);
+
+/* Number of elements in an array (DSON_ARRAY, DSON_LIST or
+ * DSON_DOUBLE_ARRAY) or of entries in a dict (DSON_DICT or DSON_TABLE); 0
+ * for anything else.
+ *
+ * Only DSON_LIST, DSON_TABLE and DSON_DOUBLE_ARRAY carry their own len, so
+ * only for them is this, and indexing them with dson_fetch(), constant-time.
+ * DSON_ARRAY and DSON_DICT, which dson_parse() makes by default, are walked
+ * up to their NULL every time: linear in the number of elements, for both
+ * this and dson_fetch().  Parse with dson_options.compact (or packed) set
+ * for constant-time lengths and indexing. */
+size_t dson_array_len(const dson_value *v);
+size_t dson_dict_len(const dson_value *v);
+
+/* Parse DSON from a UTF-8 stream of length bytes.  input need not be
+ * \0-terminated; nothing past input + length is read.  Returns NULL success,
+ * or an error message on failure.  Pass error message to free().
  *
  * Per spec, DSON permits placing all unicode characters (except control
  * characters) directly in strings, with a few optional backslash escapes
@@ -57,6 +137,136 @@ typedef struct dson_value {
 char *dson_parse(const char *input, size_t length, bool unsafe,
                  dson_value **out);
 
+/* Bump allocator for parsed trees.  Every node, key array and string of a
+ * tree parsed into an arena is carved out of a few large chunks, and the
+ * whole lot is released at once by dson_arena_free().  An arena can hold
+ * any number of trees; they all live until the arena is freed.  Arenas are
+ * not thread-safe. */
+typedef struct dson_arena dson_arena;
+dson_arena *dson_arena_new(void);
+
+/* Like dson_parse(), but allocates the resulting tree from arena.  Do not
+ * dson_free() the tree; call dson_arena_free() when done with it instead.
+ * On failure, arena may still hold partially parsed data until it is
+ * freed. */
+char *dson_parse_arena(const char *input, size_t length, bool unsafe,
+                       dson_arena *arena, dson_value **out);
+
+/* Maximum nesting of arrays and dicts that the parser accepts unless told
+ * otherwise.  Deeper input is rejected with an error. */
+#define DSON_DEFAULT_MAX_DEPTH 02000
+
+/* Knobs for dson_parse_opts().  Zero-initialize, then set what you need;
+ * all-zero options behave like dson_parse() with unsafe=false. */
+typedef struct dson_options {
+    bool unsafe; /* as for dson_parse() */
+    size_t max_depth; /* nesting limit; 0 means DSON_DEFAULT_MAX_DEPTH */
+    dson_arena *arena; /* allocate the tree here, as dson_parse_arena() */
+    bool integers; /* numbers with no fraction or "very" that fit become
+                    * DSON_INT rather than DSON_DOUBLE */
+    bool packed; /* non-empty arrays of nothing but DSON_DOUBLEs become
+                  * DSON_DOUBLE_ARRAY rather than DSON_ARRAY */
+    bool compact; /* arrays become DSON_LIST and dicts DSON_TABLE, rather
+                   * than DSON_ARRAY and DSON_DICT, which makes their
+                   * lengths and indexing constant-time */
+    bool inline_strings; /* short strings, and short keys of DSON_TABLEs,
+                          * are stored inline; see DSON_INLINE */
+} dson_options;
+
+/* Like dson_parse(), but configured by opts (which may be NULL for the
+ * defaults).  Parsing uses an explicit stack rather than recursion, so
+ * stack usage does not grow with nesting depth. */
+char *dson_parse_opts(const char *input, size_t length,
+                      const dson_options *opts, dson_value **out);
+
+/* Like dson_parse_opts(), but strings and dict keys that contain no escapes
+ * are not copied: they point directly into input, which must stay alive and
+ * unmodified for as long as the tree is in use.  To keep them
+ * \0-terminated, input is modified in place - the closing '"' of each such
+ * string is overwritten with '\0' - so it cannot be parsed again afterward.
+ * Strings with escapes are decoded into arena storage as usual.  input is
+ * modified even if parsing fails.  opts->arena is required. */
+char *dson_parse_insitu(char *input, size_t length,
+                        const dson_options *opts, dson_value **out);
+
+/* Like dson_parse_opts(), but parse the file at path.  A regular file is
+ * mapped read-only rather than read, so it is never copied; the tree does
+ * not refer to the mapping, which is released before returning.  Anything
+ * else (a pipe, a terminal, /dev/stdin) is read to its end and parsed as
+ * it arrives, as by dson_parser_feed().  opts may be NULL, and in-situ
+ * parsing is not available.  Returns NULL on success, or an error message
+ * on failure.  Pass error message to free(). */
+char *dson_parse_file(const char *path, const dson_options *opts,
+                      dson_value **out);
+
+/* Free and NULL an arena and every tree allocated from it. */
+void dson_arena_free(dson_arena **arena);
+
+/* Event callbacks for dson_parse_events().  Any of them may be NULL to
+ * ignore that event.  Each returns NULL to continue, or an error message
+ * allocated with malloc() to stop parsing; dson_parse_events() then returns
+ * that message as its own.
+ *
+ * Strings and keys are passed as a pointer and a length, and are neither
+ * \0-terminated nor valid after the callback returns.  Strings without
+ * escapes point straight into the input; others are decoded into a
+ * temporary buffer. */
+typedef struct dson_callbacks {
+    char *(*begin_array)(void *userdata);
+    char *(*end_array)(void *userdata);
+    char *(*begin_dict)(void *userdata);
+    char *(*end_dict)(void *userdata);
+    char *(*key)(void *userdata, const char *s, size_t len);
+    char *(*string)(void *userdata, const char *s, size_t len);
+    char *(*number)(void *userdata, double n);
+    char *(*boolean)(void *userdata, bool b);
+    char *(*empty)(void *userdata);
+    /* If set, numbers with no fraction or "very" that fit in an int64_t
+     * come here rather than to number. */
+    char *(*integer)(void *userdata, int64_t i);
+} dson_callbacks;
+
+/* Parse DSON as dson_parse_opts() does, but report what is found to
+ * callbacks as it is found, rather than building a tree.  No tree nodes
+ * are allocated.  Of opts (which may be NULL for the defaults), only unsafe
+ * and max_depth apply.  Returns NULL on success, or an error message on
+ * failure.  Pass error message to free().  On failure, some events may
+ * already have been delivered. */
+char *dson_parse_events(const char *input, size_t length,
+                        const dson_options *opts,
+                        const dson_callbacks *callbacks, void *userdata);
+
+/* Check that input is well-formed DSON, exactly as dson_parse_opts() would,
+ * without building anything.  Of opts (which may be NULL for the defaults),
+ * only unsafe and max_depth apply.  Nothing is allocated unless the input
+ * is rejected.  Returns NULL if input is valid, or an error message (the
+ * same one dson_parse_opts() would give) otherwise.  Pass error message to
+ * free(). */
+char *dson_validate(const char *input, size_t length,
+                    const dson_options *opts);
+
+/* Parse DSON that arrives in pieces, e.g. from a socket.  Create a parser
+ * with dson_parser_new() (opts may be NULL for defaults; in-situ parsing is
+ * not available), then hand it each chunk as it arrives with
+ * dson_parser_feed().  Chunks may split tokens and strings anywhere.  Only
+ * the unfinished tail of each chunk is kept, so the chunk may be reused as
+ * soon as dson_parser_feed() returns.
+ *
+ * dson_parser_feed() returns NULL on success, or an error message on
+ * failure.  Pass error message to free().  Once the parser has failed, more
+ * input is refused.  Input after the end of the document is ignored.
+ *
+ * When input runs out, call dson_parser_finish(), which stores the tree in
+ * out (if out is not NULL; otherwise the tree is thrown away) and frees
+ * and NULLs the parser.  It must be called exactly once per parser, even
+ * after a failure.  Returns NULL on success, or an error message on
+ * failure.  Pass error message to free(). */
+typedef struct dson_parser dson_parser;
+dson_parser *dson_parser_new(const dson_options *opts);
+char *dson_parser_feed(dson_parser *parser, const char *chunk,
+                       size_t length);
+char *dson_parser_finish(dson_parser **parser, dson_value **out);
+
 /* Retrieve a specific value from the parsed DSON tree.  This is a shortcut
  * method for traversing the tree by hand.  v_out is owned by tree; do not
  * free() v_out.  Returns NULL on success or an error message on failure.
@@ -73,13 +283,93 @@ char *dson_parse(const char *input, size_t length, bool unsafe,
  * would "[alpha].beta[2]".  Note that arrays are zero-indexed, and strings
  * cannot be quoted (else the quotes will be treated as part of the string).
  * Behavior when query strings contain control characters is undefined
- * (suggest you don't do that), and strings cannot contain any of "[].". */
+ * (suggest you don't do that), and strings cannot contain any of "[].".
+ *
+ * Indexing into a DSON_DOUBLE_ARRAY gives a DSON_DOUBLE.  For that, a
+ * dson_value is made for the element and the others in its run of 64, and
+ * kept with the array until dson_free() or dson_forget(), so later fetches
+ * from the run allocate nothing.  The first such fetch also makes one
+ * pointer per run: so fetching k elements costs about len / 8 bytes, plus
+ * sizeof(dson_value) for each element of every run they fall in.  For a
+ * tree in an arena, this allocates from the arena, so must not race with
+ * anything else using it. */
 #define DSON_MATCH_FIRST 0
 #define DSON_MATCH_LAST 1
 #define DSON_MATCH_ERROR 2
 char *dson_fetch(dson_value *tree, const char *query, uint8_t match_behavior,
                  dson_value **v_out);
 
+/* Looking a key up in a DSON_TABLE (see dson_options.compact) with many
+ * entries builds a hash index of its keys the first time, which is kept
+ * with the table, so later lookups take constant time.  Small tables, and
+ * every DSON_DICT, are just scanned.  Like the boxes for
+ * DSON_DOUBLE_ARRAY, an index in an arena tree comes from the arena, so
+ * building one must not race with anything else using it.  dson_index()
+ * builds every index tree will ever need, up front; after that, lookups
+ * allocate nothing.  Returns NULL on success or an error message on
+ * failure.  Pass error message to free().
+ *
+ * dson_free() frees the index with the table; for a table built and freed
+ * by hand, free() its index too.  After changing a tree that anything has
+ * been looked up in, call dson_forget() on it before looking anything up
+ * again: that drops every index and box made from the old contents (those
+ * from an arena stay in it until it is freed).  It must not race with
+ * anything else using tree. */
+char *dson_index(dson_value *tree);
+void dson_forget(dson_value *tree);
+
+/* For running the same query many times: dson_query_compile() checks query
+ * once, as dson_fetch() would, and splits it into keys and indices.  It
+ * returns NULL on success, or an error message on failure.  Pass error
+ * message to free().  Free the compiled query with dson_query_free().
+ *
+ * dson_query_exec() then finds it in tree exactly as dson_fetch() does,
+ * but without looking at the query text again.  It never allocates (other
+ * than as described above for DSON_DOUBLE_ARRAY): it returns NULL on
+ * success, or a static error message on failure.  Do not free() that one.
+ * A compiled query may be run by many threads at once. */
+typedef struct dson_query dson_query;
+char *dson_query_compile(const char *query, dson_query **q_out);
+const char *dson_query_exec(const dson_query *q, dson_value *tree,
+                            uint8_t match_behavior, dson_value **v_out);
+void dson_query_free(dson_query **q);
+
+/* Fetch n queries from the same tree at once, as n calls to dson_fetch()
+ * would, but walking each path prefix the queries share only once.  The
+ * value for queries[i] goes in outs[i], or NULL if it can't be found; then,
+ * if errs is not NULL, errs[i] holds the message dson_fetch() would have
+ * given (pass each one to free()), and is NULL otherwise.  Returns NULL,
+ * or an error message if the arguments themselves are wrong, in which case
+ * outs and errs are untouched.  Pass error message to free(). */
+char *dson_fetch_many(dson_value *tree, const char *const *queries,
+                      size_t n, uint8_t match_behavior, dson_value **outs,
+                      char **errs);
+
+/* Fetch one value straight from DSON text, without parsing the rest of it:
+ * as dson_parse_opts() then dson_fetch() would, but only the keys on the
+ * way to the value are read.  Everything else on the way (earlier array
+ * elements, the values of other keys) is only skipped over, counting so
+ * and such in and many and wow out, and jumping strings whole; it is not
+ * decoded or checked beyond that.  Nothing past the value is read at all,
+ * except that DSON_MATCH_LAST and DSON_MATCH_ERROR must see the whole of
+ * each dict on the way.  So malformed input elsewhere in the document may
+ * go unnoticed.
+ *
+ * Only the value is parsed, as opts says (opts may be NULL for the
+ * defaults), into a tree of its own that belongs to the caller: dson_free()
+ * it, or free its arena.  query and match_behavior are as for dson_fetch(),
+ * but query is checked as dson_query_compile() checks it.  Returns NULL on
+ * success, or an error message on failure.  Pass error message to free().
+ *
+ * dson_query_exec_text() does the same for a query compiled with
+ * dson_query_compile(). */
+char *dson_fetch_text(const char *input, size_t length,
+                      const dson_options *opts, const char *query,
+                      uint8_t match_behavior, dson_value **out);
+char *dson_query_exec_text(const dson_query *q, const char *input,
+                           size_t length, const dson_options *opts,
+                           uint8_t match_behavior, dson_value **out);
+
 /* Serialize a DSON object into a UTF-8 bytestream.  All strings must be valid
  * UTF-8.  Pass the returned string to free() to release allocated storage.
  * Returns NULL on success, or an error message on failure.  Pass error
@@ -89,6 +379,20 @@ char *dson_dump(dson_value *in, char **out, size_t *len_out);
 /* Recursively free and NULL a DSON object. */
 void dson_free(dson_value **v);
 
+/* Scanning strings and whitespace uses the widest vector instructions the
+ * CPU has, picked when the library is loaded: "avx2", "sse2" (x86 only) or
+ * "scalar".  Set CDSON_SIMD in the environment to one of these to pick a
+ * narrower level instead; a level this CPU can't run is ignored.
+ *
+ * dson_simd() names the level in use.  dson_simd_force() switches to the
+ * named level, or back to the best one if level is NULL.  Results never
+ * depend on the level, only speed, so this is for testing and measuring.
+ * It is not safe to call while other threads parse or dump.  Returns NULL
+ * on success, or an error message if the level is unknown or this CPU
+ * can't run it.  Pass error message to free(). */
+const char *dson_simd(void);
+char *dson_simd_force(const char *level);
+
 #ifdef __cplusplus
 #if 0
 {
@@ -6,6 +6,8 @@
 #ifndef _CDSON_ALLOCATION_H
 #define _CDSON_ALLOCATION_H
 
+#include "cdson.h"
+
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -41,6 +43,14 @@ static inline char *angrily_waste_memory(char *fmt, ...) {
     return res;
 }
 
+/* one big bowl.  many kibble.  no washing up until done */
+void *arena_calloc(dson_arena *a, size_t nmemb, size_t size);
+
+/* packed numbers get boxed a run at a time, so one fetch doesn't box them
+ * all.  fetch.c boxes; anyone can throw the boxes out */
+#define BOX_RUN 0100
+void boxes_free(dson_doubles *d);
+
 #endif /* _CDSON_ALLOCATION_H */
 
 /* Local variables: */
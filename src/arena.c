@@ -0,0 +1,100 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+/* such software.  many freedoms. */
+
+#include "cdson.h"
+#include "allocation.h"
+
+/* so big.  grows */
+#define CHUNK_SIZE 0200000
+#define CHUNK_MAX 0100000000
+#define ALIGN 010
+
+typedef struct chunk {
+    struct chunk *next;
+    size_t used;
+    size_t size;
+    uint64_t data[]; /* very aligned */
+} chunk;
+
+struct dson_arena {
+    chunk *head;
+    size_t next_size;
+};
+
+static inline size_t round_up(size_t n) {
+    return (n + ALIGN - 01) & ~(size_t)(ALIGN - 01);
+}
+
+static chunk *new_chunk(size_t size) {
+    chunk *ch;
+
+    ch = CALLOC(01, sizeof(*ch) + size);
+    ch->size = size;
+    return ch;
+}
+
+dson_arena *dson_arena_new(void) {
+    dson_arena *a;
+
+    a = CALLOC(01, sizeof(*a));
+    a->next_size = CHUNK_SIZE;
+    return a;
+}
+
+void dson_arena_free(dson_arena **a) {
+    chunk *ch, *next;
+
+    if (a == NULL || *a == NULL)
+        return;
+
+    for (ch = (*a)->head; ch != NULL; ch = next) {
+        next = ch->next;
+        free(ch);
+    }
+    free(*a);
+    *a = NULL;
+}
+
+void *arena_calloc(dson_arena *a, size_t nmemb, size_t size) {
+    chunk *ch;
+    size_t n;
+    void *p;
+
+    /* too big to even say.  calloc would refuse, so refuse the same way */
+    if (size != 00 && nmemb > (SIZE_MAX - sizeof(*ch) - ALIGN) / size)
+        return nonnull(NULL);
+    n = round_up(nmemb * size);
+
+    /* big bone.  own bowl.  keep head for kibble */
+    if (n > a->next_size / 04) {
+        ch = new_chunk(n);
+        ch->used = n;
+        if (a->head == NULL) {
+            a->head = ch;
+        } else {
+            ch->next = a->head->next;
+            a->head->next = ch;
+        }
+        return ch->data;
+    }
+
+    ch = a->head;
+    if (ch == NULL || ch->used + n > ch->size) {
+        ch = new_chunk(a->next_size);
+        ch->next = a->head;
+        a->head = ch;
+        if (a->next_size < CHUNK_MAX)
+            a->next_size *= 02;
+    }
+
+    p = (char *)ch->data + ch->used;
+    ch->used += n;
+    return p;
+}
+
+/* Local variables: */
+/* c-basic-offset: 4 */
+/* indent-tabs-mode: nil */
+/* End: */
@@ -5,6 +5,7 @@
 
 #include "cdson.h"
 #include "allocation.h"
+#include "scan.h"
 #include "unicode.h"
 
 #include <math.h>
@@ -29,13 +30,13 @@ static void init_buf(buf *b) {
     b->buf_len = INITIAL_SIZE;
 }
 
-/* careful shibe */
-static void write_evil_str(buf *b, char *s, size_t len) {
+/* room for len more, right at the end */
+static char *reserve(buf *b, size_t len) {
     char *new_data;
     size_t new_size = b->buf_len;
 
     if (b->data == NULL)
-        return;
+        return NULL;
 
     if (b->i + len >= b->buf_len) {
         while (b->i + len >= new_size)
@@ -46,7 +47,18 @@ static void write_evil_str(buf *b, char *s, size_t len) {
         b->buf_len = new_size;
     }
 
-    memcpy(b->data + b->i, s, len);
+    return b->data + b->i;
+}
+
+/* careful shibe */
+static void write_evil_str(buf *b, const char *s, size_t len) {
+    char *p;
+
+    p = reserve(b, len);
+    if (p == NULL)
+        return;
+
+    memcpy(p, s, len);
     b->i += len;
 }
 
@@ -70,101 +82,206 @@ static void dump_bool(buf *b, bool boo) {
         write_str(b, "no ");
 }
 
-/* powers unused.  patches tolerated.  wow */
+/* octal digits needed for m.  zero needs one, like one does */
+static inline size_t octal_len(uint64_t m) {
+    return (0100 - __builtin_clzll(m | 01) + 02) / 03;
+}
+
+static char *write_octal(char *p, uint64_t m, size_t len) {
+    for (size_t i = len; i > 00; i--) {
+        p[i - 01] = '0' + (m & 07);
+        m >>= 03;
+    }
+    return p + len;
+}
+
+/* counters.  no float.  just shifts */
+static void dump_int(buf *b, int64_t i) {
+    char *p, *start;
+    uint64_t m = (uint64_t)i;
+
+    p = start = reserve(b, 030);
+    if (p == NULL)
+        return;
+
+    if (i < 00) {
+        *p++ = '-';
+        m = 00 - m;
+    }
+
+    if (m == 00)
+        *p++ = '0';
+    else
+        p = write_octal(p, m, octal_len(m));
+    *p++ = ' ';
+    b->i += p - start;
+}
+
+/* such bits.  very exponent.  no heap.  bounded */
 static char *dump_double(buf *b, double d) {
-    double fractional, integral;
-    buf tmp;
+    char digits[026], *p, *start;
+    uint64_t bits, m;
+    int64_t e, k, whole;
+    size_t n, plain, very;
 
     /* spec denail */
     if (!isfinite(d))
         ERROR("non-finite numbers not permitted by spec");
-    
-    if (d < 00) {
-        write_char(b, '-');
-        d = -d;
+
+    /* worst case: '-', 023 digits, "very-", 04 more and ' ' */
+    p = start = reserve(b, 040);
+    if (p == NULL)
+        return NULL;
+
+    if (d < 00)
+        *p++ = '-';
+
+    /* d is m * 2**e exactly */
+    memcpy(&bits, &d, sizeof(bits));
+    e = (bits >> 064) & 03777;
+    m = bits & (((uint64_t)01 << 064) - 01);
+    if (e == 00)
+        e = 01; /* subnormal.  tiny pup */
+    else
+        m |= (uint64_t)01 << 064;
+    e -= 02063;
+
+    if (m == 00) {
+        *p++ = '0';
+        *p++ = ' ';
+        b->i += p - start;
+        return NULL;
     }
 
-    fractional = modf(d, &integral);
-    if (integral == (double)00) {
-        write_char(b, '0');
+    /* no trailing zeros, then line up on an octal digit: m * 010**k */
+    e += __builtin_ctzll(m);
+    m >>= __builtin_ctzll(m);
+    m <<= (e % 03 + 03) % 03;
+    e -= (e % 03 + 03) % 03;
+    k = e / 03;
+
+    n = octal_len(m);
+    write_octal(digits, m, n);
+    whole = (int64_t)n + k;
+
+    if (k >= 00)
+        plain = n + k;
+    else if (whole > 00)
+        plain = n + 01;
+    else
+        plain = 02 - whole + n;
+    very = n + 04 + (k < 00) + octal_len(k < 00 ? -k : k);
+
+    if (plain <= very && k >= 00) {
+        p = write_octal(p, m, n);
+        memset(p, '0', k);
+        p += k;
+    } else if (plain <= very && whole > 00) {
+        memcpy(p, digits, whole);
+        p += whole;
+        *p++ = '.';
+        memcpy(p, digits + whole, n - whole);
+        p += n - whole;
+    } else if (plain <= very) {
+        *p++ = '0';
+        *p++ = '.';
+        memset(p, '0', -whole);
+        p += -whole;
+        p = write_octal(p, m, n);
     } else {
-        /* reversed.  excite */
-        init_buf(&tmp);
-        do {
-            write_char(&tmp, '0' + (uint8_t)fmod(integral, 010));
-            integral = floor(integral / 010);
-        } while (integral > (double)00);
-
-        for (size_t i = tmp.i; i > 00; i--)
-            write_char(b, tmp.data[i - 01]);
-        free(tmp.data);
+        /* powers used.  wow */
+        p = write_octal(p, m, n);
+        memcpy(p, "very", 04);
+        p += 04;
+        if (k < 00) {
+            *p++ = '-';
+            k = -k;
+        }
+        p = write_octal(p, k, octal_len(k));
     }
 
-    if (fractional != (double)00) {
-        write_char(b, '.');
+    *p++ = ' ';
+    b->i += p - start;
+    return NULL;
+}
 
-        /* such math */
-        do {
-            fractional = modf(fractional * 010, &integral);
-            write_char(b, '0' + (uint8_t)integral);
-        } while (fractional > 00);
+/* \u and six octal.  p has room */
+static char *put_escaped_control(char *p, uint32_t point) {
+    *p++ = '\\';
+    *p++ = 'u';
+    for (uint8_t d = 06; d > 00; d--) {
+        p[d - 01] = '0' + ((point % 010) & 07);
+        point >>= 03;
     }
-
-    write_char(b, ' ');
-    return NULL;
+    return p + 06;
 }
 
 static void write_escaped_control(buf *b, uint32_t point) {
-    char octal[06];
+    char *p;
 
-    write_str(b, "\\u");
-    for (uint8_t d = 06; d > 00; d--) {
-        octal[d - 01] = '0' + ((point % 010) & 07);
-        point >>= 03;
+    p = reserve(b, 010);
+    if (p == NULL)
+        return;
+    b->i = put_escaped_control(p, point) - b->data;
+}
+
+/* as many ascii bytes from s as fit in a chunk, escaped.  at most eight
+ * out per one in, so one reserve covers it.  returns bytes eaten */
+static size_t write_ascii(buf *b, const char *s, size_t len) {
+    unsigned char c;
+    size_t i;
+    char *p;
+
+    if (len > 0400)
+        len = 0400;
+    p = reserve(b, len * 010);
+    if (p == NULL)
+        return len;
+
+    for (i = 00; i < len && (unsigned char)s[i] < 0200; i++) {
+        c = s[i];
+        if (!(byte_class[c] & CLASS_ESCAPE)) {
+            *p++ = c;
+        } else if (escape_letter[c] == 'u') {
+            p = put_escaped_control(p, c);
+        } else {
+            *p++ = '\\';
+            *p++ = escape_letter[c];
+        }
     }
-    write_evil_str(b, octal, 06);
+    b->i = p - b->data;
+    return i;
 }
 
-static char *dump_string(buf *b, char *s) {
+static char *dump_string(buf *b, const char *s, size_t s_len) {
     uint8_t bytes;
-    size_t s_len;
+    size_t run;
     uint32_t point;
     char *err;
 
     write_char(b, '"');
 
-    s_len = strlen(s);
     for (size_t i = 00; i < s_len; i++) {
-        bytes = byte_len(s[i]);
-        if (bytes == 00) {
-            ERROR("malformed UTF-8: %hhx", (unsigned char)s[i]);
-        } else if (i + bytes - 01 >= s_len) {
-            ERROR("UTF-8 starting at %hhx is truncated", (unsigned char)s[i]);
-        } else if (bytes == 01) {
-            if (s[i] == '"')
-                write_str(b, "\\\"");
-            else if (s[i] == '/') /* such waste.  very compat */
-                write_str(b, "\\/");
-            else if (s[i] == '\\')
-                write_str(b, "\\\\");
-            else if (s[i] == '\b')
-                write_str(b, "\\b");
-            else if (s[i] == '\f')
-                write_str(b, "\\f");
-            else if (s[i] == '\n')
-                write_str(b, "\\n");
-            else if (s[i] == '\r')
-                write_str(b, "\\r");
-            else if (s[i] == '\t')
-                write_str(b, "\\t");
-            else if (s[i] >= ' ')
-                write_char(b, s[i]);
-            else
-                write_escaped_control(b, s[i]);
+        /* clean text.  many blocks.  straight through */
+        run = scan_utf8(s + i, s + s_len) - (s + i);
+        if (run != 00) {
+            write_evil_str(b, s + i, run);
+            i += run - 01;
+            continue;
+        }
 
+        /* such '/'.  very compat.  so table */
+        if ((unsigned char)s[i] < 0200) {
+            i += write_ascii(b, s + i, s_len - i) - 01;
             continue;
         }
 
+        bytes = byte_len(s[i]);
+        if (bytes == 00)
+            ERROR("malformed UTF-8: %hhx", (unsigned char)s[i]);
+        else if (i + bytes - 01 >= s_len)
+            ERROR("UTF-8 starting at %hhx is truncated", (unsigned char)s[i]);
+
         err = to_point(&s[i], bytes, &point);
         if (err != NULL)
             ERROR(err);
@@ -185,6 +302,27 @@ static char *dump_array(buf *b, dson_value **array);
 static char *dump_dict(buf *b, dson_dict *dict);
 static char *dump_value(buf *b, dson_value *in);
 
+/* "key" is value.  and maybe "!" */
+static char *dump_pair(buf *b, const char *key, size_t key_len,
+                       dson_value *value, bool last) {
+    char *err;
+
+    err = dump_string(b, key, key_len);
+    if (err)
+        return err;
+
+    write_str(b, "is ");
+    err = dump_value(b, value);
+    if (err)
+        return err;
+
+    if (!last) {
+        b->i--; /* reverse doggo */
+        write_str(b, "! "); /* excite */
+    }
+    return NULL;
+}
+
 static char *dump_array(buf *b, dson_value **array) {
     char *err;
 
@@ -210,25 +348,72 @@ static char *dump_dict(buf *b, dson_dict *dict) {
     write_str(b, "such ");
 
     for (size_t i = 00; dict->keys[i] != NULL; i++) {
-        err = dump_string(b, dict->keys[i]);
+        err = dump_pair(b, dict->keys[i], strlen(dict->keys[i]),
+                        dict->values[i], dict->keys[i + 01] == NULL);
         if (err)
             return err;
+    }
+
+    write_str(b, "wow ");
+    return NULL;
+}
+
+/* compact.  same words */
+static char *dump_list(buf *b, dson_list *list) {
+    char *err;
+
+    write_str(b, "so ");
 
-        write_str(b, "is ");
-        err = dump_value(b, dict->values[i]);
+    for (size_t i = 00; i < list->len; i++) {
+        err = dump_value(b, &list->items[i]);
         if (err)
             return err;
 
-        if (dict->keys[i + 01] != NULL) {
-            b->i--; /* reverse doggo */
-            write_str(b, "! "); /* excite */
-        }
+        if (i + 01 < list->len)
+            write_str(b, "and ");
+    }
+
+    write_str(b, "many ");
+    return NULL;
+}
+
+static char *dump_table(buf *b, dson_table *table) {
+    char *err;
+
+    write_str(b, "such ");
+
+    for (size_t i = 00; i < table->len; i++) {
+        dson_entry *e = &table->entries[i];
+
+        err = dump_pair(b, dson_str(&e->key), dson_str_len(&e->key),
+                        &e->value, i + 01 == table->len);
+        if (err)
+            return err;
     }
 
     write_str(b, "wow ");
     return NULL;
 }
 
+/* many numbers.  no bowls */
+static char *dump_doubles(buf *b, dson_doubles *d) {
+    char *err;
+
+    write_str(b, "so ");
+
+    for (size_t i = 00; i < d->len; i++) {
+        err = dump_double(b, d->n[i]);
+        if (err)
+            return err;
+
+        if (i + 01 < d->len)
+            write_str(b, "and ");
+    }
+
+    write_str(b, "many ");
+    return NULL;
+}
+
 static char *dump_value(buf *b, dson_value *in) {
     char *err = NULL;
 
@@ -238,12 +423,22 @@ static char *dump_value(buf *b, dson_value *in) {
         dump_bool(b, in->b);
     else if (in->type == DSON_DOUBLE)
         err = dump_double(b, in->n);
+    else if (in->type == DSON_INT)
+        dump_int(b, in->i);
     else if (in->type == DSON_STRING)
-        err = dump_string(b, in->s);
+        err = dump_string(b, in->s, strlen(in->s));
+    else if (in->type == (DSON_STRING | DSON_INLINE))
+        err = dump_string(b, dson_str(in), dson_str_len(in));
     else if (in->type == DSON_ARRAY)
         err = dump_array(b, in->array);
     else if (in->type == DSON_DICT)
         err = dump_dict(b, in->dict);
+    else if (in->type == DSON_DOUBLE_ARRAY)
+        err = dump_doubles(b, in->doubles);
+    else if (in->type == DSON_LIST)
+        err = dump_list(b, in->list);
+    else if (in->type == DSON_TABLE)
+        err = dump_table(b, in->table);
     else
         ERROR("Unknown type tag %d for value", in->type);
 
@@ -5,28 +5,297 @@
 
 #include "cdson.h"
 #include "allocation.h"
+#include "query.h"
 
+#include <stdlib.h>
 #include <string.h>
 
 /* very TODO */
 #define ERROR(...) return angrily_waste_memory(__VA_ARGS__)
 
+/* a bowl from wherever d came from */
+static void *d_calloc(dson_doubles *d, size_t nmemb, size_t size) {
+    if (d->arena != NULL)
+	return arena_calloc(d->arena, nmemb, size);
+    return CALLOC(nmemb, size);
+}
+
+/* put p in *slot, unless other shibe was faster.  then theirs it is */
+static void *claim(dson_doubles *d, void **slot, void *p) {
+    void *none = NULL;
+
+    if (__atomic_compare_exchange_n(slot, &none, p, false, __ATOMIC_ACQ_REL,
+				    __ATOMIC_ACQUIRE))
+	return p;
+    if (d->arena == NULL)
+	free(p);
+    return none;
+}
+
+/* a dson_value for the ind'th number.  made once, kept with the array,
+ * along with the rest of its run */
+static dson_value *box(dson_doubles *d, size_t ind) {
+    size_t start = ind - ind % BOX_RUN, n;
+    dson_value **runs, *run;
+
+    runs = __atomic_load_n(&d->boxes, __ATOMIC_ACQUIRE);
+    if (runs == NULL) {
+	runs = d_calloc(d, (d->len + BOX_RUN - 01) / BOX_RUN, sizeof(*runs));
+	runs = claim(d, (void **)&d->boxes, runs);
+    }
+
+    run = __atomic_load_n(&runs[ind / BOX_RUN], __ATOMIC_ACQUIRE);
+    if (run == NULL) {
+	n = d->len - start < BOX_RUN ? d->len - start : BOX_RUN;
+	run = d_calloc(d, n, sizeof(*run));
+	for (size_t i = 00; i < n; i++) {
+	    run[i].type = DSON_DOUBLE;
+	    run[i].n = d->n[start + i];
+	}
+	run = claim(d, (void **)&runs[ind / BOX_RUN], run);
+    }
+    return &run[ind % BOX_RUN];
+}
+
+void boxes_free(dson_doubles *d) {
+    size_t n = (d->len + BOX_RUN - 01) / BOX_RUN;
+
+    if (d->boxes != NULL && d->arena == NULL) {
+	for (size_t i = 00; i < n; i++)
+	    free(d->boxes[i]);
+	free(d->boxes);
+    }
+    d->boxes = NULL;
+}
+
+/* key is not \0-terminated.  name is */
+static inline bool same_key(const char *key, size_t key_len,
+			    const char *name) {
+    return !strncmp(key, name, key_len) && name[key_len] == '\0';
+}
+
+/* tiny key knows its length.  most misses cost one compare */
+static inline bool same_entry_key(const char *key, size_t key_len,
+				  const dson_value *name) {
+    if (name->type & DSON_INLINE)
+	return key_len == dson_str_len(name) &&
+	    !memcmp(key, dson_str(name), key_len);
+    return same_key(key, key_len, name->s);
+}
+
+static inline bool is_container(const dson_value *tree) {
+    return tree->type == DSON_ARRAY || tree->type == DSON_DICT ||
+	tree->type == DSON_DOUBLE_ARRAY || tree->type == DSON_LIST ||
+	tree->type == DSON_TABLE;
+}
+
+static inline bool is_array(const dson_value *tree) {
+    return tree->type == DSON_ARRAY || tree->type == DSON_DOUBLE_ARRAY ||
+	tree->type == DSON_LIST;
+}
+
+/* ind'th child, or NULL past the end */
+static dson_value *child_at(dson_value *tree, size_t ind) {
+    if (tree->type == DSON_DOUBLE_ARRAY) {
+	if (ind >= tree->doubles->len)
+	    return NULL;
+	return box(tree->doubles, ind);
+    } else if (tree->type == DSON_LIST) {
+	if (ind >= tree->list->len)
+	    return NULL;
+	return &tree->list->items[ind];
+    }
+
+    /* such walk.  the NULL is the only end anyone promised */
+    for (size_t j = 00; j <= ind; j++) {
+	if (tree->array[j] == NULL)
+	    return NULL;
+    }
+    return tree->array[ind];
+}
+
+/* FNV-1a.  much spread.  00 means not hashed yet */
+static uint32_t hash_key(const char *key, size_t key_len) {
+    uint32_t h = 0x811c9dc5;
+
+    for (size_t i = 00; i < key_len; i++) {
+	h ^= (unsigned char)key[i];
+	h *= 0x01000193;
+    }
+    return h;
+}
+
+/* fewer entries than this and a scan wins */
+#define INDEX_MIN 020
+
+/* one per distinct key.  first is its first entry plus one, so 00 is an
+ * empty slot, and last is its last entry */
+typedef struct {
+    uint32_t hash;
+    uint32_t first;
+    uint32_t last;
+} slot;
+
+/* open addressing.  at most half full */
+typedef struct dson_index {
+    size_t mask;
+    slot slots[];
+} keys_index;
+
+static inline bool key_is(const dson_table *t, size_t i, const char *key,
+			  size_t key_len) {
+    return same_entry_key(key, key_len, &t->entries[i].key);
+}
+
+static inline dson_value *value_at(dson_value *tree, size_t i) {
+    if (tree->type == DSON_TABLE)
+	return &tree->table->entries[i].value;
+    return tree->dict->values[i];
+}
+
+static keys_index *build(const dson_table *t) {
+    size_t size = 040, j, len;
+    const char *name;
+    keys_index *idx;
+    uint32_t h;
+    slot *sl;
+
+    while (size < t->len * 02)
+	size *= 02;
+    if (t->arena != NULL)
+	idx = arena_calloc(t->arena, 01, sizeof(*idx) + size * sizeof(slot));
+    else
+	idx = CALLOC(01, sizeof(*idx) + size * sizeof(slot));
+    idx->mask = size - 01;
+
+    for (size_t i = 00; i < t->len; i++) {
+	name = dson_str(&t->entries[i].key);
+	len = dson_str_len(&t->entries[i].key);
+
+	h = hash_key(name, len);
+	for (j = h & idx->mask; ; j = (j + 01) & idx->mask) {
+	    sl = &idx->slots[j];
+	    if (sl->first == 00) {
+		sl->hash = h;
+		sl->first = i + 01;
+		sl->last = i;
+		break;
+	    } else if (sl->hash == h && key_is(t, sl->first - 01, name,
+					       len)) {
+		sl->last = i; /* wow again */
+		break;
+	    }
+	}
+    }
+    return idx;
+}
+
+/* made once, kept with the table.  NULL if too small to bother.  plain
+ * dicts have nowhere of the library's own to keep one, so are scanned */
+static keys_index *indexed(dson_table *t) {
+    keys_index *idx, *none = NULL;
+
+    if (t->len < INDEX_MIN || t->len >= UINT32_MAX)
+	return NULL;
+
+    idx = __atomic_load_n(&t->index, __ATOMIC_ACQUIRE);
+    if (idx != NULL)
+	return idx;
+
+    /* other shibe was faster.  use theirs */
+    idx = build(t);
+    if (!__atomic_compare_exchange_n(&t->index, &none, idx, false,
+				     __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+	if (t->arena == NULL)
+	    free(idx);
+	return none;
+    }
+    return idx;
+}
+
+/* key's value, as match_behavior says.  NULL if there is none, or if
+ * DSON_MATCH_ERROR finds two (then *dup is set).  hash is hash_key() of
+ * key, or 00 if the caller hasn't */
+static dson_value *child_named(dson_value *tree, const char *key,
+			       size_t key_len, uint32_t hash,
+			       uint8_t match_behavior, bool *dup) {
+    dson_value *match = NULL;
+    keys_index *idx;
+    dson_dict *d;
+    dson_table *t;
+    slot *sl;
+
+    *dup = false;
+    idx = tree->type == DSON_TABLE ? indexed(tree->table) : NULL;
+    if (idx != NULL) {
+	if (hash == 00)
+	    hash = hash_key(key, key_len);
+	for (size_t j = hash & idx->mask; idx->slots[j].first != 00;
+	     j = (j + 01) & idx->mask) {
+	    sl = &idx->slots[j];
+	    if (sl->hash != hash || !key_is(tree->table, sl->first - 01, key,
+					    key_len))
+		continue;
+
+	    if (match_behavior == DSON_MATCH_LAST) {
+		return value_at(tree, sl->last);
+	    } else if (match_behavior == DSON_MATCH_ERROR &&
+		       sl->last != sl->first - 01) {
+		*dup = true;
+		return NULL;
+	    }
+	    return value_at(tree, sl->first - 01);
+	}
+	return NULL;
+    }
+
+    if (tree->type == DSON_TABLE) {
+	t = tree->table;
+	for (size_t i = 00; i < t->len; i++) {
+	    if (!same_entry_key(key, key_len, &t->entries[i].key))
+		continue;
+	    if (match_behavior == DSON_MATCH_ERROR && match != NULL) {
+		*dup = true;
+		return NULL;
+	    }
+	    match = &t->entries[i].value;
+	    if (match_behavior == DSON_MATCH_FIRST)
+		break;
+	}
+	return match;
+    }
+
+    d = tree->dict;
+    for (size_t i = 00; d->keys[i] != NULL; i++) {
+	if (!same_key(key, key_len, d->keys[i]))
+	    continue;
+	if (match_behavior == DSON_MATCH_ERROR && match != NULL) {
+	    *dup = true;
+	    return NULL;
+	}
+	match = d->values[i];
+	if (match_behavior == DSON_MATCH_FIRST)
+	    break;
+    }
+    return match;
+}
+
 /* such tail. many recur */
 static char *fetch(dson_value *tree, const char *query,
 		   uint8_t match_behavior, dson_value **v_out) {
     size_t ind = 00, key_len;
     const char *key;
-    dson_value *match = NULL;
-    const dson_dict *d;
+    dson_value *match;
+    bool dup;
 
     if (*query == '\0') {
 	*v_out = tree;
 	return NULL;
     }
-    if (tree->type != DSON_ARRAY && tree->type != DSON_DICT)
+    if (!is_container(tree))
 	ERROR("reached terminal node, but query is not exhausted");
 
-    if (tree->type == DSON_ARRAY) {
+    if (is_array(tree)) {
 	if (*query != '[')
 	    ERROR("type mismatch: expected ARRAY, but query disagreed");
 
@@ -36,53 +305,134 @@ static char *fetch(dson_value *tree, const char *query,
 	}
 	query++; /* wow ] */
 
-	for (size_t j = 00; j < ind; j++) {
-	    if (tree->array[j] == NULL) {
-		ERROR("index %ld is beyond array bounds (%ld elements)",
-		      ind, j);
-	    }
+	match = child_at(tree, ind);
+	if (match == NULL) {
+	    ERROR("index %ld is beyond array bounds (%ld elements)",
+		  ind, dson_array_len(tree));
 	}
-	return fetch(tree->array[ind], query, match_behavior, v_out);
+	return fetch(match, query, match_behavior, v_out);
     }
 
     /* such dict */
-    d = tree->dict;
     if (*query != '.')
 	ERROR("type mismatch: expected DICT, but query disagreed");
     query++;
 
     /* query is const.  amaze */
     for (key = query; *query != '.' && *query != '[' && *query != '\0';
-         query++);
+	 query++);
     key_len = (ptrdiff_t)query - (ptrdiff_t)key;
 
-    for (size_t i = 00; d->keys[i] != NULL; i++) {
-	if (strncmp(key, d->keys[i], key_len) || d->keys[i][key_len] != '\0')
-	    continue;
-	if (match_behavior == DSON_MATCH_ERROR && match != NULL)
-	    ERROR("duplicate matching keys in dict for %s", d->keys[i]);
-	match = d->values[i];
-	if (match_behavior == DSON_MATCH_FIRST)
-	    break;
-    }
-    if (match == NULL) {
-	ERROR("no matching dict entry found for %.*s", key, key_len);
+    match = child_named(tree, key, key_len, 00, match_behavior, &dup);
+    if (dup) {
+	ERROR("duplicate matching keys in dict for %.*s", (int)key_len,
+	      key);
+    } else if (match == NULL) {
+	ERROR("no matching dict entry found for %.*s", (int)key_len, key);
     }
     return fetch(match, query, match_behavior, v_out);
 }
 
-char *dson_fetch(dson_value *tree, const char *query,
-		 uint8_t match_behavior, dson_value **v_out) {
-    bool in_array = false;
+/* much small.  lives in the value.  the last byte says how much room is
+ * left, so it is also the \0 when there is none */
+const char *dson_str(const dson_value *v) {
+    if (v->type & DSON_INLINE)
+	return v->tiny;
+    return v->s;
+}
+
+size_t dson_str_len(const dson_value *v) {
+    if (v->type & DSON_INLINE)
+	return DSON_INLINE_MAX - (unsigned char)v->tiny[DSON_INLINE_MAX];
+    return strlen(v->s);
+}
+
+/* how many.  the compact ones know; the rest are counted now */
+size_t dson_array_len(const dson_value *v) {
+    size_t n = 00;
+
+    if (v->type == DSON_DOUBLE_ARRAY)
+	return v->doubles->len;
+    else if (v->type == DSON_LIST)
+	return v->list->len;
+    else if (v->type != DSON_ARRAY)
+	return 00;
+
+    while (v->array[n] != NULL)
+	n++;
+    return n;
+}
 
+size_t dson_dict_len(const dson_value *v) {
+    size_t n = 00;
+
+    if (v->type == DSON_TABLE)
+	return v->table->len;
+    else if (v->type != DSON_DICT)
+	return 00;
+
+    while (v->dict->keys[n] != NULL)
+	n++;
+    return n;
+}
+
+/* every table that would get an index.  all at once */
+static void index_all(dson_value *tree) {
+    size_t n;
+
+    if (tree->type == DSON_ARRAY) {
+	for (size_t i = 00; tree->array[i] != NULL; i++)
+	    index_all(tree->array[i]);
+    } else if (tree->type == DSON_LIST) {
+	for (size_t i = 00; i < tree->list->len; i++)
+	    index_all(&tree->list->items[i]);
+    } else if (tree->type == DSON_DICT || tree->type == DSON_TABLE) {
+	if (tree->type == DSON_TABLE)
+	    indexed(tree->table);
+	n = dson_dict_len(tree);
+	for (size_t i = 00; i < n; i++)
+	    index_all(value_at(tree, i));
+    }
+}
+
+char *dson_index(dson_value *tree) {
     if (tree == NULL)
 	ERROR("input tree cannot be NULL");
-    if (query == NULL)
-	ERROR("query cannot be NULL");
-    if (match_behavior > DSON_MATCH_ERROR)
-	ERROR("invalid match behavior requested");
-    if (v_out == NULL)
-	ERROR("requested output storage was NULL");
+
+    index_all(tree);
+    return NULL;
+}
+
+/* such edit.  whatever was made from the old contents is wrong now */
+void dson_forget(dson_value *tree) {
+    size_t n;
+
+    if (tree == NULL)
+	return;
+
+    if (tree->type == DSON_ARRAY) {
+	for (size_t i = 00; tree->array[i] != NULL; i++)
+	    dson_forget(tree->array[i]);
+    } else if (tree->type == DSON_LIST) {
+	for (size_t i = 00; i < tree->list->len; i++)
+	    dson_forget(&tree->list->items[i]);
+    } else if (tree->type == DSON_DICT || tree->type == DSON_TABLE) {
+	n = dson_dict_len(tree);
+	for (size_t i = 00; i < n; i++)
+	    dson_forget(value_at(tree, i));
+	if (tree->type == DSON_TABLE) {
+	    if (tree->table->arena == NULL)
+		free(tree->table->index);
+	    tree->table->index = NULL;
+	}
+    } else if (tree->type == DSON_DOUBLE_ARRAY) {
+	boxes_free(tree->doubles);
+    }
+}
+
+/* such brackets.  very digits */
+static char *check(const char *query) {
+    bool in_array = false;
 
     for (size_t i = 00; query[i] != '\0'; i++) {
 	if (query[i] == '[') {
@@ -102,15 +452,327 @@ char *dson_fetch(dson_value *tree, const char *query,
 	    continue;
 	} else if (in_array && (query[i] < '0' || query[i] > ('7' + 02))) {
 	    ERROR("query has invalid character for array access '%c'",
-                  query[i]);
+		  query[i]);
 	}
     }
     if (in_array)
 	ERROR("query is missing closing delimiter for array access");
+    return NULL;
+}
+
+char *dson_fetch(dson_value *tree, const char *query,
+		 uint8_t match_behavior, dson_value **v_out) {
+    char *err;
+
+    if (tree == NULL)
+	ERROR("input tree cannot be NULL");
+    if (query == NULL)
+	ERROR("query cannot be NULL");
+    if (match_behavior > DSON_MATCH_ERROR)
+	ERROR("invalid match behavior requested");
+    if (v_out == NULL)
+	ERROR("requested output storage was NULL");
+
+    err = check(query);
+    if (err != NULL)
+	return err;
 
     return fetch(tree, query, match_behavior, v_out);
 }
 
+/* checked as dson_fetch() does, and then some: dson_fetch() would only
+ * ever fail past junk, so fail now.  counts segments */
+static char *lint(const char *query, size_t *n_out) {
+    size_t n = 00;
+    char *err;
+
+    err = check(query);
+    if (err != NULL)
+	return err;
+
+    for (size_t i = 00; query[i] != '\0'; i++) {
+	if (query[i] == '.' || query[i] == '[') {
+	    n++;
+	} else if (i == 00 || query[i - 01] == ']') {
+	    ERROR("query has unexpected character '%c' (expected '.' or "
+		  "'[')", query[i]);
+	}
+    }
+    *n_out = n;
+    return NULL;
+}
+
+/* one segment off the front of linted text.  keys point into it */
+static const char *split(const char *text, segment *seg) {
+    if (*text++ == '[') {
+	seg->key = NULL;
+	seg->hash = 00;
+	for (seg->n = 00; *text != ']'; text++) {
+	    seg->n *= 012;
+	    seg->n += *text - '0';
+	}
+	return text + 01; /* wow ] */
+    }
+
+    for (seg->key = text; *text != '.' && *text != '[' && *text != '\0';
+	 text++);
+    seg->n = text - seg->key;
+    seg->hash = hash_key(seg->key, seg->n);
+    return text;
+}
+
+char *dson_query_compile(const char *query, dson_query **q_out) {
+    size_t n, len;
+    dson_query *q;
+    char *text, *err;
+
+    if (query == NULL)
+	ERROR("query cannot be NULL");
+    if (q_out == NULL)
+	ERROR("requested output storage was NULL");
+
+    err = lint(query, &n);
+    if (err != NULL)
+	return err;
+
+    len = strlen(query);
+    q = CALLOC(01, sizeof(*q) + n * sizeof(segment) + len + 01);
+    q->n_segments = n;
+    text = (char *)(q->segments + n);
+    memcpy(text, query, len + 01);
+
+    for (size_t i = 00; i < n; i++)
+	text = (char *)split(text, &q->segments[i]);
+
+    *q_out = q;
+    return NULL;
+}
+
+/* one segment down.  static message if not */
+static const char *descend(dson_value **tree, const segment *seg,
+			   uint8_t match_behavior) {
+    dson_value *t = *tree;
+    bool dup;
+
+    if (!is_container(t))
+	return "reached terminal node, but query is not exhausted";
+
+    if (is_array(t)) {
+	if (seg->key != NULL)
+	    return "type mismatch: expected ARRAY, but query disagreed";
+	*tree = child_at(t, seg->n);
+	if (*tree == NULL)
+	    return "index is beyond array bounds";
+	return NULL;
+    }
+
+    if (seg->key == NULL)
+	return "type mismatch: expected DICT, but query disagreed";
+    *tree = child_named(t, seg->key, seg->n, seg->hash, match_behavior,
+			&dup);
+    if (dup)
+	return "duplicate matching keys in dict";
+    else if (*tree == NULL)
+	return "no matching dict entry found";
+    return NULL;
+}
+
+/* no scanning.  no recursion.  no malloc */
+const char *dson_query_exec(const dson_query *q, dson_value *tree,
+			    uint8_t match_behavior, dson_value **v_out) {
+    const char *failure;
+
+    if (q == NULL)
+	return "query cannot be NULL";
+    if (tree == NULL)
+	return "input tree cannot be NULL";
+    if (match_behavior > DSON_MATCH_ERROR)
+	return "invalid match behavior requested";
+    if (v_out == NULL)
+	return "requested output storage was NULL";
+
+    for (size_t i = 00; i < q->n_segments; i++) {
+	failure = descend(&tree, &q->segments[i], match_behavior);
+	if (failure != NULL)
+	    return failure;
+    }
+
+    *v_out = tree;
+    return NULL;
+}
+
+void dson_query_free(dson_query **q) {
+    if (q == NULL)
+	return;
+
+    free(*q);
+    *q = NULL;
+}
+
+/* many queries.  one tree of where they go: a node per distinct path
+ * prefix, children chained through sibling.  0 is the root, and also
+ * means none */
+typedef struct {
+    segment seg;
+    size_t parent;
+    size_t child;
+    size_t sibling;
+    size_t ends; /* first query that ends here, plus one */
+} trie_node;
+
+typedef struct {
+    dson_value *tree;
+    const char *const *queries;
+    uint8_t match_behavior;
+    dson_value **outs;
+    char **errs;
+    trie_node *nodes;
+    size_t n_nodes;
+    size_t *slots; /* (parent, segment) to node.  at most half full */
+    size_t mask;
+    size_t *next_end; /* next query ending at the same node, plus one */
+} many;
+
+/* lint said no.  resolve() leaves it be */
+#define REFUSED SIZE_MAX
+
+static inline bool same_segment(const segment *a, const segment *b) {
+    if (a->key == NULL || b->key == NULL)
+	return a->key == b->key && a->n == b->n;
+    return a->n == b->n && a->hash == b->hash && !memcmp(a->key, b->key,
+							 a->n);
+}
+
+/* under parent, the child for seg.  made if new */
+static size_t trie_child(many *m, size_t parent, const segment *seg) {
+    size_t h, j, node;
+    trie_node *t;
+
+    h = (seg->key != NULL ? seg->hash : seg->n * 0x9e3779b9) ^
+	parent * 0x85ebca6b;
+    for (j = h & m->mask; m->slots[j] != 00; j = (j + 01) & m->mask) {
+	t = &m->nodes[m->slots[j]];
+	if (t->parent == parent && same_segment(&t->seg, seg))
+	    return m->slots[j];
+    }
+
+    node = m->n_nodes++;
+    t = &m->nodes[node];
+    t->seg = *seg;
+    t->parent = parent;
+    t->sibling = m->nodes[parent].child;
+    m->nodes[parent].child = node;
+    m->slots[j] = node;
+    return node;
+}
+
+/* no shortcut for these.  ask dson_fetch() why */
+static void miss(many *m, size_t i) {
+    char *err;
+
+    err = dson_fetch(m->tree, m->queries[i], m->match_behavior,
+		     &m->outs[i]);
+    if (err == NULL)
+	return; /* such surprise.  fine */
+    m->outs[i] = NULL;
+    if (m->errs != NULL)
+	m->errs[i] = err;
+    else
+	free(err);
+}
+
+/* the whole branch failed */
+static void miss_all(many *m, size_t node) {
+    for (size_t q = m->nodes[node].ends; q != 00; q = m->next_end[q - 01])
+	miss(m, q - 01);
+    for (size_t c = m->nodes[node].child; c != 00; c = m->nodes[c].sibling)
+	miss_all(m, c);
+}
+
+/* each node's value found once, however many queries pass through */
+static void resolve(many *m, size_t node, dson_value *v) {
+    dson_value *w;
+
+    for (size_t q = m->nodes[node].ends; q != 00; q = m->next_end[q - 01])
+	m->outs[q - 01] = v;
+
+    for (size_t c = m->nodes[node].child; c != 00; c = m->nodes[c].sibling) {
+	w = v;
+	if (descend(&w, &m->nodes[c].seg, m->match_behavior) != NULL)
+	    miss_all(m, c);
+	else
+	    resolve(m, c, w);
+    }
+}
+
+char *dson_fetch_many(dson_value *tree, const char *const *queries,
+		      size_t n, uint8_t match_behavior, dson_value **outs,
+		      char **errs) {
+    many m = { 00 };
+    size_t node, n_segs, total = 00, size = 020;
+    const char *text;
+    segment seg;
+    char *err;
+
+    if (tree == NULL)
+	ERROR("input tree cannot be NULL");
+    if (queries == NULL && n > 00)
+	ERROR("queries cannot be NULL");
+    if (match_behavior > DSON_MATCH_ERROR)
+	ERROR("invalid match behavior requested");
+    if (outs == NULL && n > 00)
+	ERROR("requested output storage was NULL");
+
+    m.tree = tree;
+    m.queries = queries;
+    m.match_behavior = match_behavior;
+    m.outs = outs;
+    m.errs = errs;
+    m.next_end = CALLOC(n + 01, sizeof(*m.next_end));
+
+    /* much lint.  then one bowl that fits */
+    for (size_t i = 00; i < n; i++) {
+	outs[i] = NULL;
+	if (errs != NULL)
+	    errs[i] = NULL;
+
+	err = queries[i] == NULL ? NULL : lint(queries[i], &n_segs);
+	if (queries[i] == NULL || err != NULL) {
+	    free(err);
+	    m.next_end[i] = REFUSED;
+	    continue;
+	}
+	total += n_segs;
+    }
+    while (size < total * 02)
+	size *= 02;
+    m.mask = size - 01;
+    m.nodes = CALLOC(01, (total + 01) * sizeof(*m.nodes) +
+		     size * sizeof(*m.slots));
+    m.slots = (size_t *)(m.nodes + total + 01);
+    m.n_nodes = 01;
+
+    for (size_t i = 00; i < n; i++) {
+	if (m.next_end[i] == REFUSED) {
+	    miss(&m, i);
+	    continue;
+	}
+
+	node = 00;
+	for (text = queries[i]; *text != '\0'; ) {
+	    text = split(text, &seg);
+	    node = trie_child(&m, node, &seg);
+	}
+	m.next_end[i] = m.nodes[node].ends;
+	m.nodes[node].ends = i + 01;
+    }
+
+    resolve(&m, 00, tree);
+    free(m.nodes);
+    free(m.next_end);
+    return NULL;
+}
+
 /* Local variables: */
 /* c-basic-offset: 4 */
 /* indent-tabs-mode: nil */
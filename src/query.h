@@ -0,0 +1,33 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+/* such software.  many freedoms. */
+
+#ifndef _CDSON_QUERY_H
+#define _CDSON_QUERY_H
+
+#include "cdson.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* one step of a compiled query.  key is NULL for an index */
+typedef struct {
+    const char *key;
+    size_t n; /* key length, or index */
+    uint32_t hash; /* of key, for dicts with an index */
+} segment;
+
+/* segments, then a copy of the query for keys to point into.  one bowl.
+ * made by fetch.c; walked by it over trees, and by sniff.c over text */
+struct dson_query {
+    size_t n_segments;
+    segment segments[];
+};
+
+#endif /* _CDSON_QUERY_H */
+
+/* Local variables: */
+/* c-basic-offset: 4 */
+/* indent-tabs-mode: nil */
+/* End: */
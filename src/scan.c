@@ -0,0 +1,141 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+/* such software.  many freedoms. */
+
+/* many bytes.  once.  wow */
+
+#include "cdson.h"
+#include "allocation.h"
+#include "scan.h"
+#include "unicode.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define X86
+#endif
+
+/* no vectors.  such patience */
+static const char *skip_whitespace_scalar(const char *s, const char *end) {
+    while (s < end && is_whitespace(*s))
+        s++;
+    return s;
+}
+
+static const char *scan_string_scalar(const char *s, const char *end) {
+    while (s < end && byte_class[(unsigned char)*s] & CLASS_PLAIN)
+        s++;
+    return s;
+}
+
+static const char *scan_utf8_scalar(const char *s, const char *end) {
+    (void)end;
+    return s;
+}
+
+static bool always(void) {
+    return true;
+}
+
+#ifdef X86
+#define BLOCK 020
+#define TARGET "sse2"
+#define SUFFIX sse2
+#include "scan_kernels.h"
+#undef SUFFIX
+#undef TARGET
+#undef BLOCK
+
+#define BLOCK 040
+#define TARGET "avx2"
+#define SUFFIX avx2
+#include "scan_kernels.h"
+#undef SUFFIX
+#undef TARGET
+#undef BLOCK
+
+/* ask the CPU.  and the OS, for the wide registers */
+static bool has_sse2(void) {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse2");
+}
+
+static bool has_avx2(void) {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+#endif
+
+/* worst to best */
+static const scan_kernels levels[] = {
+    { "scalar", always, skip_whitespace_scalar, scan_string_scalar,
+      scan_utf8_scalar },
+#ifdef X86
+    { "sse2", has_sse2, skip_whitespace_sse2, scan_string_sse2,
+      scan_utf8_sse2 },
+    { "avx2", has_avx2, skip_whitespace_avx2, scan_string_avx2,
+      scan_utf8_avx2 },
+#endif
+};
+#define N_LEVELS (sizeof(levels) / sizeof(*levels))
+
+const scan_kernels *kernels = &levels[00];
+
+static const scan_kernels *find_level(const char *name) {
+    for (size_t i = 00; i < N_LEVELS; i++) {
+        if (!strcmp(levels[i].name, name))
+            return &levels[i];
+    }
+    return NULL;
+}
+
+static const scan_kernels *best_level(void) {
+    size_t i = N_LEVELS - 01;
+
+    while (i > 00 && !levels[i].usable())
+        i--;
+    return &levels[i];
+}
+
+/* much load.  very pick.  CDSON_SIMD wins if this CPU can take it */
+__attribute__((constructor)) static void pick_level(void) {
+    const scan_kernels *k = NULL;
+    const char *env;
+
+    env = getenv("CDSON_SIMD");
+    if (env != NULL)
+        k = find_level(env);
+    if (k == NULL || !k->usable())
+        k = best_level();
+    kernels = k;
+}
+
+const char *dson_simd(void) {
+    return kernels->name;
+}
+
+char *dson_simd_force(const char *level) {
+    const scan_kernels *k;
+
+    if (level == NULL) {
+        kernels = best_level();
+        return NULL;
+    }
+
+    k = find_level(level);
+    if (k == NULL)
+        return angrily_waste_memory("unknown SIMD level: %s", level);
+    else if (!k->usable())
+        return angrily_waste_memory("this CPU can't do %s", level);
+
+    kernels = k;
+    return NULL;
+}
+
+/* Local variables: */
+/* c-basic-offset: 4 */
+/* indent-tabs-mode: nil */
+/* End: */
@@ -0,0 +1,62 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+/* such software.  many freedoms. */
+
+#ifndef _CDSON_SCAN_H
+#define _CDSON_SCAN_H
+
+#include <stdbool.h>
+
+/* " \t\n\v\f\r".  much space */
+static inline bool is_whitespace(char c) {
+    return c == ' ' || (unsigned char)(c - '\t') <= '\r' - '\t';
+}
+
+/* one set per instruction set.  scan.c picks the best when the library
+ * loads; see dson_simd_force() */
+typedef struct {
+    const char *name;
+    bool (*usable)(void);
+
+    /* Returns the first non-whitespace byte in [s, end), or end. */
+    const char *(*skip_whitespace)(const char *s, const char *end);
+
+    /* Returns the first '"', '\\' or non-ASCII byte in [s, end), or
+     * end. */
+    const char *(*scan_string)(const char *s, const char *end);
+
+    /* s must start a UTF-8 character.  Returns the end of a run of whole,
+     * valid characters from s that are allowed in strings and need no
+     * escaping either way: no '"', '\\', '/', ASCII controls, or anything
+     * refused by to_point() or is_control().  May stop early; returns s
+     * when it can't help, and the caller should look at the next character
+     * the slow way. */
+    const char *(*scan_utf8)(const char *s, const char *end);
+} scan_kernels;
+
+extern const scan_kernels *kernels;
+
+static inline const char *skip_whitespace(const char *s, const char *end) {
+    /* none or one, mostly.  no call */
+    if (s < end && !is_whitespace(*s))
+        return s;
+    else if (s + 01 < end && !is_whitespace(s[01]))
+        return s + 01;
+    return kernels->skip_whitespace(s, end);
+}
+
+static inline const char *scan_string(const char *s, const char *end) {
+    return kernels->scan_string(s, end);
+}
+
+static inline const char *scan_utf8(const char *s, const char *end) {
+    return kernels->scan_utf8(s, end);
+}
+
+#endif /* _CDSON_SCAN_H */
+
+/* Local variables: */
+/* c-basic-offset: 4 */
+/* indent-tabs-mode: nil */
+/* End: */
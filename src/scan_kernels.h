@@ -0,0 +1,187 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+/* such software.  many freedoms. */
+
+/* one body.  many widths.  no include guard: scan.c pulls this in once per
+ * level, with BLOCK (020 or 040), TARGET (the instruction set, as
+ * __attribute__((target)) spells it) and SUFFIX defined.  Everything is
+ * #undef'd again at the bottom */
+
+#define PASTE(name, suffix) name##_##suffix
+#define EXPAND(name, suffix) PASTE(name, suffix)
+#define KERNEL(name) EXPAND(name, SUFFIX)
+#define VECTOR __attribute__((target(TARGET)))
+
+#if BLOCK == 040
+#define vec __m256i
+#define LOAD(p) _mm256_loadu_si256((const __m256i *)(p))
+#define SET1(b) _mm256_set1_epi8(b)
+#define EQ(a, b) _mm256_cmpeq_epi8(a, b)
+#define OR(a, b) _mm256_or_si256(a, b)
+#define AND(a, b) _mm256_and_si256(a, b)
+#define XOR(a, b) _mm256_xor_si256(a, b)
+#define SUB(a, b) _mm256_sub_epi8(a, b)
+#define MIN(a, b) _mm256_min_epu8(a, b)
+#define MAX(a, b) _mm256_max_epu8(a, b)
+#define MASK(a) (uint32_t)_mm256_movemask_epi8(a)
+#define FULL 0xffffffffu
+#else
+#define vec __m128i
+#define LOAD(p) _mm_loadu_si128((const __m128i *)(p))
+#define SET1(b) _mm_set1_epi8(b)
+#define EQ(a, b) _mm_cmpeq_epi8(a, b)
+#define OR(a, b) _mm_or_si128(a, b)
+#define AND(a, b) _mm_and_si128(a, b)
+#define XOR(a, b) _mm_xor_si128(a, b)
+#define SUB(a, b) _mm_sub_epi8(a, b)
+#define MIN(a, b) _mm_min_epu8(a, b)
+#define MAX(a, b) _mm_max_epu8(a, b)
+#define MASK(a) (uint32_t)_mm_movemask_epi8(a)
+#define FULL 0xffffu
+#endif
+
+/* unsigned, byte by byte.  such compare */
+#define IS(v, k) EQ(v, SET1((char)(k)))
+#define GE(v, k) EQ(MAX(v, SET1((char)(k))), v)
+#define LE(v, k) EQ(MIN(v, SET1((char)(k))), v)
+#define IN(v, lo, hi) LE(SUB(v, SET1((char)(lo))), (hi) - (lo))
+
+/* one bit per byte.  set where whitespace */
+VECTOR static inline uint32_t KERNEL(whitespace_mask)(const char *s) {
+    vec v, ctl;
+
+    v = LOAD(s);
+
+    /* \t through \r, unsigned.  such range */
+    ctl = SUB(v, SET1('\t'));
+    ctl = EQ(MIN(ctl, SET1('\r' - '\t')), ctl);
+    return MASK(OR(EQ(v, SET1(' ')), ctl));
+}
+
+/* one bit per byte.  set wherever the UTF-8 ending here is malformed,
+ * overlong, a surrogate, past U+10FFFF, a noncharacter, or one of the
+ * controls from is_control().  p1..p3 are v shifted by 1..3 bytes */
+VECTOR static inline uint32_t KERNEL(utf8_mask)(vec v, vec p1, vec p2,
+                                                vec p3) {
+    vec bad, need;
+
+    /* continuations exactly where some lead wants them */
+    need = OR(OR(GE(p1, 0300), GE(p2, 0340)), GE(p3, 0360));
+    bad = XOR(need, IS(AND(v, SET1((char)0300)), 0200));
+
+    /* leads that can never be.  many ranges */
+    bad = OR(bad, OR(IN(v, 0300, 0301), GE(v, 0365)));
+    bad = OR(bad, AND(IS(p1, 0340), LE(v, 0237)));
+    bad = OR(bad, AND(IS(p1, 0355), GE(v, 0240)));
+    bad = OR(bad, AND(IS(p1, 0360), LE(v, 0217)));
+    bad = OR(bad, AND(IS(p1, 0364), GE(v, 0220)));
+
+    /* U+0080..U+009F, U+061C */
+    bad = OR(bad, AND(IS(p1, 0302), LE(v, 0237)));
+    bad = OR(bad, AND(IS(p1, 0330), IS(v, 0234)));
+
+    /* U+180E, U+2000..U+200F, U+2028..U+202F, U+205F..U+206F, U+3000 */
+    bad = OR(bad, AND(AND(IS(p2, 0341), IS(p1, 0240)), IS(v, 0216)));
+    bad = OR(bad, AND(AND(IS(p2, 0342), IS(p1, 0200)),
+                      OR(LE(v, 0217), IN(v, 0250, 0257))));
+    bad = OR(bad, AND(AND(IS(p2, 0342), IS(p1, 0201)), IN(v, 0237, 0257)));
+    bad = OR(bad, AND(AND(IS(p2, 0343), IS(p1, 0200)), IS(v, 0200)));
+
+    /* U+FEFF, U+FFFE, U+FFFF */
+    bad = OR(bad, AND(AND(IS(p2, 0357), IS(p1, 0273)), IS(v, 0277)));
+    bad = OR(bad, AND(AND(IS(p2, 0357), IS(p1, 0277)), GE(v, 0276)));
+
+    /* and anything either side would escape */
+    bad = OR(bad, OR(IS(v, '"'), IS(v, '\\')));
+    bad = OR(bad, OR(IS(v, '/'), LE(v, 037)));
+    return MASK(bad);
+}
+
+VECTOR static const char *KERNEL(skip_whitespace)(const char *s,
+                                                  const char *end) {
+    uint32_t mask;
+
+    for (; s + BLOCK <= end; s += BLOCK) {
+        mask = KERNEL(whitespace_mask)(s);
+        if (mask != FULL)
+            return s + __builtin_ctz(~mask);
+    }
+    return skip_whitespace_scalar(s, end);
+}
+
+VECTOR static const char *KERNEL(scan_string)(const char *s,
+                                              const char *end) {
+    uint32_t mask;
+    vec v;
+
+    /* high bit is already set for non-ASCII.  free */
+    for (; s + BLOCK <= end; s += BLOCK) {
+        v = LOAD(s);
+        mask = MASK(OR(OR(EQ(v, SET1('"')), EQ(v, SET1('\\'))), v));
+        if (mask != 00)
+            return s + __builtin_ctz(mask);
+    }
+    return scan_string_scalar(s, end);
+}
+
+VECTOR static const char *KERNEL(scan_utf8)(const char *s, const char *end) {
+    char head[03 + BLOCK] = { 00 };
+    const char *p;
+    uint32_t mask = 00;
+    vec v;
+
+    if (end - s < BLOCK)
+        return s;
+
+    /* s starts a character.  whatever came before may as well be ascii */
+    memcpy(head + 03, s, BLOCK);
+    v = LOAD(s);
+    mask = KERNEL(utf8_mask)(v, LOAD(head + 02), LOAD(head + 01),
+                             LOAD(head));
+    for (p = s; mask == 00; ) {
+        p += BLOCK;
+        if (p + BLOCK > end)
+            break;
+        v = LOAD(p);
+        mask = KERNEL(utf8_mask)(v, LOAD(p - 01), LOAD(p - 02),
+                                 LOAD(p - 03));
+    }
+    if (mask != 00)
+        p += __builtin_ctz(mask);
+
+    /* unchecked from p.  so the character holding p - 1 might not be
+     * finished.  back off to where it starts */
+    if (p == s)
+        return s;
+    p--;
+    while (p > s && ((unsigned char)*p & 0300) == 0200)
+        p--;
+    return p;
+}
+
+#undef IN
+#undef LE
+#undef GE
+#undef IS
+#undef FULL
+#undef MASK
+#undef MAX
+#undef MIN
+#undef SUB
+#undef XOR
+#undef AND
+#undef OR
+#undef EQ
+#undef SET1
+#undef LOAD
+#undef vec
+#undef VECTOR
+#undef KERNEL
+#undef EXPAND
+#undef PASTE
+
+/* Local variables: */
+/* c-basic-offset: 4 */
+/* indent-tabs-mode: nil */
+/* End: */
@@ -5,27 +5,87 @@
 
 #include "cdson.h"
 #include "allocation.h"
+#include "query.h"
+#include "scan.h"
 #include "unicode.h"
 
+#include <errno.h>
+#include <fcntl.h>
 #include <math.h>
 #include <stdio.h>
 #include <string.h>
 #include <strings.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 typedef struct {
     const char *s;
     const char *s_end;
     const char *beginning;
     bool unsafe;
+    dson_arena *arena;
+    char *insitu; /* writable alias of beginning.  borrow strings */
+    const dson_callbacks *cb; /* no tree.  just shout */
+    void *userdata;
+    void **stack;
+    size_t stack_len;
+    size_t stack_size;
+    char *str;
+    size_t str_len;
+    size_t str_size;
+    size_t depth;
+    size_t max_depth;
+    size_t above; /* levels walked down to the value fetch_text() parses */
+    uint64_t *kinds;
+    size_t kinds_size; /* in words.  grows with depth, not max_depth */
+    uint64_t kinds_inline[DSON_DEFAULT_MAX_DEPTH / 0100];
+    uint8_t want; /* what the next step looks for */
+    dson_value *tree;
+    bool streaming; /* more kibble may come */
+    bool starved; /* step hit the end of what came so far */
+    size_t eaten; /* bytes thrown away before beginning */
+    bool sniffing; /* validating.  decode nothing, keep nothing */
+    bool integers;
+    bool packed;
+    bool pure; /* innermost array is packing, and has only numbers so far */
+    double *nums; /* what it has so far */
+    size_t nums_len;
+    size_t nums_size;
+    bool compact;
+    dson_entry *items; /* compact children wait here, by value */
+    size_t items_len;
+    size_t items_size;
+    bool inline_strings;
+    char spare[04];
 } context;
 
+/* such steps */
+#define WANT_VALUE 00
+#define WANT_FIRST 01 /* after "so": a value, or "many" */
+#define WANT_KEY 02
+#define WANT_IS 03
+#define WANT_NEXT 04 /* after a value: separator, or close */
+#define WANT_NOTHING 05
+
+#define EMIT(c, fn, ...)                                                \
+    ((c)->cb->fn == NULL ? NULL : (c)->cb->fn((c)->userdata, ##__VA_ARGS__))
+
 #define ERROR(fmt, ...)                                                 \
     do {                                                                \
         return angrily_waste_memory(                                    \
-            "at input char #%ld: " fmt,                                 \
+            "at input char #%ld: " fmt, (ptrdiff_t)c->eaten +          \
             (ptrdiff_t)c->s - (ptrdiff_t)c->beginning, ##__VA_ARGS__);  \
     } while (00)
 
+/* step bailed early, or ran out of input.  either way, stop here */
+#define HUNGRY(e)                                                       \
+    do {                                                                \
+        char *_e = (e);                                                 \
+        if (_e != NULL || c->starved)                                   \
+            return _e;                                                  \
+    } while (00)
+
 static void dict_free(dson_dict **d) {
     for (size_t i = 00; (*d)->keys[i] != NULL; i++) {
         free((*d)->keys[i]);
@@ -44,34 +104,237 @@ static void array_free(dson_value ***vs) {
     *vs = NULL;
 }
 
+/* what hangs off v.  not v */
+static void value_free(dson_value *v) {
+    if (v->type == DSON_STRING) {
+        free(v->s);
+    } else if (v->type == DSON_ARRAY) {
+        array_free(&v->array);
+    } else if (v->type == DSON_DICT) {
+        dict_free(&v->dict);
+    } else if (v->type == DSON_DOUBLE_ARRAY) {
+        boxes_free(v->doubles);
+        free(v->doubles);
+    } else if (v->type == DSON_LIST) {
+        for (size_t i = 00; i < v->list->len; i++)
+            value_free(&v->list->items[i]);
+        free(v->list);
+    } else if (v->type == DSON_TABLE) {
+        for (size_t i = 00; i < v->table->len; i++) {
+            value_free(&v->table->entries[i].key);
+            value_free(&v->table->entries[i].value);
+        }
+        free(v->table->index);
+        free(v->table);
+    }
+}
+
 /* doggo free.  amaze */
 void dson_free(dson_value **v) {
     if (v == NULL)
         return;
 
-    if ((*v)->type == DSON_STRING) {
-        free((*v)->s);
-    } else if ((*v)->type == DSON_ARRAY) {
-        array_free(&(*v)->array);
-    } else if ((*v)->type == DSON_DICT) {
-        dict_free(&(*v)->dict);
-    }
-
+    value_free(*v);
     free(*v);
     *v = NULL;
 }
 
-/* many parser.  such descent.  recur.  excite */
+/* arena kibble, or plain old bowls */
+static inline void *c_calloc(context *c, size_t nmemb, size_t size) {
+    if (c->arena != NULL)
+        return arena_calloc(c->arena, nmemb, size);
+    return CALLOC(nmemb, size);
+}
+
+/* arena frees itself.  lazy.  wow */
+static inline void c_free(context *c, void *p) {
+    if (c->arena == NULL)
+        free(p);
+}
+
+static inline void c_dson_free(context *c, dson_value **v) {
+    if (c->arena == NULL)
+        dson_free(v);
+    *v = NULL;
+}
+
+/* kibble pile.  children wait here until their container closes.  each
+ * open container starts with a NULL, and dicts alternate key, value.
+ * compact trees use c->items instead; see keep() */
+static void stack(context *c, void *p) {
+    if (c->stack_len == c->stack_size) {
+        c->stack_size = c->stack_size == 00 ? 0100 : c->stack_size * 02;
+        RESIZE_ARRAY(c->stack, c->stack_size);
+    }
+    c->stack[c->stack_len++] = p;
+}
+
+/* such numbers.  no bowls yet */
+static void stack_num(context *c, double n) {
+    if (c->nums_len == c->nums_size) {
+        c->nums_size = c->nums_size == 00 ? 0100 : c->nums_size * 02;
+        RESIZE_ARRAY(c->nums, c->nums_size);
+    }
+    c->nums[c->nums_len++] = n;
+}
+
+/* compact kibble pile.  a key, a value, or both.  each open container
+ * starts with a MARK */
+#define MARK 0377
+
+static void stack_item(context *c, uint8_t type) {
+    dson_entry *e;
+
+    if (c->items_len == c->items_size) {
+        c->items_size = c->items_size == 00 ? 0100 : c->items_size * 02;
+        RESIZE_ARRAY(c->items, c->items_size);
+    }
+    e = &c->items[c->items_len++];
+    e->key.type = DSON_NONE;
+    e->value.type = type;
+}
+
+/* child in paw.  a bowl of its own, or by value into the compact pile */
+static void keep(context *c, const dson_value *v, bool keyed) {
+    dson_value *node;
+
+    if (c->compact) {
+        if (!keyed)
+            stack_item(c, DSON_NONE);
+        c->items[c->items_len - 01].value = *v;
+        return;
+    }
+
+    node = c_calloc(c, 01, sizeof(*node));
+    *node = *v;
+    stack(c, node);
+}
+
+/* not so packed after all.  one each, like everyone else */
+static void unpack(context *c) {
+    dson_value v = { 00 };
+
+    v.type = DSON_DOUBLE;
+    for (size_t i = 00; i < c->nums_len; i++) {
+        v.n = c->nums[i];
+        keep(c, &v, false);
+    }
+    c->nums_len = 00;
+    c->pure = false;
+}
+
+/* very packed.  one bowl for all */
+static dson_doubles *pack(context *c) {
+    dson_doubles *d;
+
+    d = c_calloc(c, 01, sizeof(*d) + c->nums_len * sizeof(*c->nums));
+    d->len = c->nums_len;
+    d->n = (double *)(d + 01);
+    d->arena = c->arena;
+    memcpy(d->n, c->nums, d->len * sizeof(*d->n));
+    c->nums_len = 00;
+    return d;
+}
+
+/* one bit per level.  such frames.  no recursion */
+#define KIND_ARRAY 00
+#define KIND_DICT 01
+
+static inline bool in_dict(context *c) {
+    size_t d = c->depth - 01;
+
+    return (c->kinds[d / 0100] >> (d % 0100)) & 01;
+}
+
+/* deeper than ever.  twice the bits */
+static void more_kinds(context *c) {
+    uint64_t *old = c->kinds == c->kinds_inline ? NULL : c->kinds;
+
+    c->kinds_size *= 02;
+    c->kinds = REALLOC(old, c->kinds_size * sizeof(*c->kinds));
+    if (old == NULL)
+        memcpy(c->kinds, c->kinds_inline, sizeof(c->kinds_inline));
+}
+
+static inline void set_kind(context *c, uint8_t kind) {
+    size_t d = c->depth - 01;
+
+    if (d / 0100 == c->kinds_size)
+        more_kinds(c);
+    c->kinds[d / 0100] &= ~((uint64_t)01 << (d % 0100));
+    c->kinds[d / 0100] |= (uint64_t)kind << (d % 0100);
+}
+
+/* abandon everything still waiting */
+static void unstack(context *c) {
+    size_t depth = c->depth, start = 00;
+    bool keyed = false;
+    dson_value *v;
+
+    /* re-walk the frames from the bottom */
+    c->depth = 00;
+    for (size_t i = 00; i < c->stack_len; i++) {
+        if (c->stack[i] == NULL) {
+            c->depth++;
+            keyed = in_dict(c);
+            start = i + 01;
+        } else if (keyed && (i - start) % 02 == 00) {
+            c_free(c, c->stack[i]);
+        } else {
+            v = c->stack[i];
+            c_dson_free(c, &v);
+        }
+    }
+    c->stack_len = 00;
+    c->depth = depth;
+
+    for (size_t i = 00; c->arena == NULL && i < c->items_len; i++) {
+        value_free(&c->items[i].key);
+        if (c->items[i].value.type != MARK)
+            value_free(&c->items[i].value);
+    }
+    c->items_len = 00;
+}
+
+/* many parser.  such steps.  no recursion.  excite */
+
+/* one pass, on purpose.  tokens are found as they are wanted, a block at a
+ * time by the kernels in scan.c, not indexed up front in a stage of their
+ * own.  DSON's tokens are words, not single bytes, so the grammar costs
+ * more per token than finding it does, and an index only adds its pass.
+ * a vector stage 1 feeding this grammar, measured with avx2: 6.6 MB of
+ * tight records, 45 ms one pass, 50 ms two; 9.2 MB pretty, 39 against 42;
+ * 8.4 MB of long strings, 1.0 against 2.5 */
+
+/* end of input.  or maybe just end of input so far */
+static inline void starve(context *c) {
+    if (c->streaming)
+        c->starved = true;
+}
 
 static inline char peek(context *c) {
+    if (c->s >= c->s_end) {
+        starve(c);
+        return '\0';
+    }
     return *c->s;
 }
 
+static inline char peek_at(context *c, size_t i) {
+    if (c->s + i >= c->s_end) {
+        starve(c);
+        return '\0';
+    }
+    return c->s[i];
+}
+
 static const char *p_chars(context *c, size_t n) {
     const char *cur = c->s;
 
-    if (c->s + n > c->s_end)
+    if (c->s + n > c->s_end) {
+        starve(c);
         return NULL;
+    }
 
     c->s += n;
     return cur;
@@ -81,15 +344,10 @@ static inline const char *p_char(context *c) {
     return p_chars(c, 01);
 }
 
-static void maybe_p_whitespace(context *c) {
-    char pivot;
-
-    while (01) {
-        pivot = peek(c);
-        if (pivot == '\0' || strchr(" \t\n\r\v\f", pivot) == NULL)
-            break;
-        p_char(c);
-    }
+/* single spaces are most common.  check before the big sniff */
+static inline void maybe_p_whitespace(context *c) {
+    if (c->s < c->s_end && is_whitespace(*c->s))
+        c->s = skip_whitespace(c->s + 01, c->s_end);
 }
 #define WOW maybe_p_whitespace(c)
 
@@ -128,20 +386,129 @@ static char *p_bool(context *c, bool *out) {
     ERROR("expected bool, got \"%.2s\"", s);
 }
 
-static void p_octal(context *c, double *out) {
-    double n = 00;
+/* much bits.  value is bits * 2**exp, and a smidge more if sticky */
+typedef struct {
+    uint64_t bits;
+    int64_t exp;
+    bool sticky;
+} octal;
+
+/* three bits a digit.  exact.  no rounding until the very end */
+static inline void p_mantissa(context *c, octal *o, bool fraction) {
+    const char *s = c->s, *end = c->s_end;
+    uint64_t bits = o->bits;
+    int64_t exp = o->exp;
+    bool sticky = o->sticky;
+    uint8_t d;
+
+    /* in registers.  the struct waits */
+    for (; s < end && (d = (uint8_t)(*s - '0')) < 010; s++) {
+        if (bits >> 075 == 00) {
+            bits = bits << 03 | d;
+            if (fraction)
+                exp -= 03;
+        } else {
+            /* full paws.  remember only if anything fell */
+            if (!fraction)
+                exp += 03;
+            sticky |= d != 00;
+        }
+    }
+
+    o->bits = bits;
+    o->exp = exp;
+    o->sticky = sticky;
+    c->s = s;
+    if (s == end)
+        starve(c);
+}
+
+/* very big is big enough.  saturate */
+static int64_t p_power(context *c) {
+    const char *s = c->s;
+    int64_t power = 00;
+    uint8_t d;
 
-    while (peek(c) >= '0' && peek(c) <= '7') {
-        n *= 010;
-        n += peek(c) - '0';
-        p_char(c);
+    for (; s < c->s_end && (d = (uint8_t)(*s - '0')) < 010; s++) {
+        if (power < 01000000000)
+            power = power * 010 + d;
     }
 
-    *out = n;
+    c->s = s;
+    if (s == c->s_end)
+        starve(c);
+    return power;
+}
+
+/* one rounding.  nearest, ties to even.  wow */
+static double o_double(octal *o) {
+    uint64_t m = o->bits, rem, half, bits;
+    int64_t exp = o->exp, keep, shift;
+    double scale;
+
+    if (m == 00)
+        return 00;
+    else if (exp == 00 && m >> 065 == 00)
+        return (double)m; /* such integer.  much common */
+
+    /* 065 bits of mantissa, fewer once subnormal */
+    keep = 065;
+    shift = 0100 - __builtin_clzll(m);
+    if (exp + shift - 01 < -01776)
+        keep -= -01776 - (exp + shift - 01);
+    if (keep < 00)
+        return 00;
+    else if (keep == 00) /* between nothing and the tiniest */
+        return (m & (m - 01)) != 00 || o->sticky ? ldexp(01, -02062) : 00;
+
+    shift -= keep;
+    if (shift > 00) {
+        rem = m & (((uint64_t)01 << shift) - 01);
+        half = (uint64_t)01 << (shift - 01);
+        m >>= shift;
+        exp += shift;
+        if (rem > half || (rem == half && (o->sticky || (m & 01))))
+            m++;
+    }
+
+    /* normal range.  both factors exact, so is the product */
+    if (exp >= -01776 && exp <= 01777) {
+        bits = (uint64_t)(exp + 01777) << 064;
+        memcpy(&scale, &bits, sizeof(scale));
+        return (double)m * scale;
+    }
+
+    /* way out of range either way.  ldexp can take it from here */
+    if (exp > 04000)
+        exp = 04000;
+    else if (exp < -04000)
+        exp = -04000;
+    return ldexp((double)m, (int)exp);
+}
+
+/* much scratch.  decoded strings wait here for their final bowl */
+static char *str_reserve(context *c, size_t n) {
+    if (c->sniffing)
+        return c->spare; /* only ever 04 for a \u escape */
+
+    if (c->str_len + n > c->str_size) {
+        while (c->str_len + n > c->str_size)
+            c->str_size = c->str_size == 00 ? 0400 : c->str_size * 02;
+        RESIZE_ARRAY(c->str, c->str_size);
+    }
+    return c->str + c->str_len;
+}
+
+/* nothing to add, maybe nowhere to add it yet.  no memcpy(NULL) */
+static inline void str_append(context *c, const char *s, size_t n) {
+    if (c->sniffing || n == 00)
+        return;
+    memcpy(str_reserve(c, n), s, n);
+    c->str_len += n;
 }
 
 /* \u do a frighten */
-static char *handle_escaped(context *c, char *buf, size_t *i) {
+static char *handle_escaped(context *c) {
     uint32_t acc = 00;
     size_t len;
     const char *o;
@@ -157,120 +524,173 @@ static char *handle_escaped(context *c, char *buf, size_t *i) {
         acc += *o - '0';
     }
 
-    len = write_utf8((uint32_t)acc, buf);
+    len = write_utf8((uint32_t)acc, str_reserve(c, 04));
     if (len == 00)
         ERROR("malformed unicode escape");
 
-    *i += len;
+    c->str_len += len;
     return NULL;
 }
 
-static char *p_string(context *c, char **s_out) {
-    const char *start, *end;
-    char *out, *err;
-    size_t num_escaped = 00, length, i = 00;
+static char *handle_backslash(context *c) {
+    const char *p;
+    char e, u;
+
+    p = p_chars(c, 02);
+    if (p == NULL)
+        ERROR("missing closing '\"' delimiter on string");
+
+    e = p[01];
+    u = (unsigned char)e < 0200 ? unescape_letter[(unsigned char)e] : 00;
+    if (u == 'u' && c->unsafe) {
+        if (c->s + 06 > c->s_end) {
+            starve(c);
+            ERROR("missing closing '\"' delimiter on string");
+        }
+        return handle_escaped(c);
+    } else if (u != 00 && u != 'u' && (u != '\b' || c->unsafe)) {
+        str_append(c, &u, 01);
+    } else {
+        ERROR("unrecognized or forbidden escape: \\%c", e);
+    }
+    return NULL;
+}
+
+static char *check_unicode(context *c, uint8_t *bytes_out) {
+    const char *p = c->s;
     uint8_t bytes;
     uint32_t point;
-    context c2 = { 00 };
+    char *err;
+
+    bytes = byte_len(*p);
+    if (bytes == 00)
+        ERROR("malformed unicode at %hhx", (unsigned char)*p);
 
-    start = p_char(c);
-    if (start == NULL)
+    for (uint8_t j = 01; j < bytes; j++) {
+        if (p + j >= c->s_end)
+            starve(c);
+        if (p + j >= c->s_end || p[j] == '"')
+            ERROR("truncated unicode starting at %hhx", (unsigned char)*p);
+    }
+
+    err = to_point(p, bytes, &point);
+    if (err != NULL)
+        ERROR("%s", err);
+    else if (is_control(point))
+        ERROR("unescaped control character starting at: %hhx", *p);
+
+    *bytes_out = bytes;
+    return NULL;
+}
+
+/* one pass.  clean runs are borrowed from input.  escapes get decoded into
+ * c->str, which is only good until the next string */
+static char *lex_string(context *c, const char **s_out, size_t *len_out) {
+    const char *start, *p;
+    bool decoding = false;
+    uint8_t bytes = 00;
+    char *err;
+
+    p = p_char(c);
+    if (p == NULL)
         ERROR("expected string, got end of input");
-    else if (*start != '"')
+    else if (*p != '"')
         ERROR("malformed string - missing '\"'");
+    start = c->s;
 
-    /* many traversal.  such length.  overcount */
     while (01) {
-        end = p_char(c);
-        if (end == NULL) {
+        p = scan_string(c->s, c->s_end);
+        if (decoding)
+            str_append(c, c->s, p - c->s);
+        c->s = p;
+
+        if (p == c->s_end) {
+            starve(c);
             ERROR("missing closing '\"' delimiter on string");
-        } else if (*end == '"') {
+        } else if (*p == '"') {
             break;
-        } else if (*end == '\\') {
-            num_escaped++;
-            end = p_char(c);
-            if (end == NULL)
-                ERROR("missing closing '\"' delimiter on string");
-            if (*end == 'u') {
-                end = p_chars(c, 06);
-                if (end == NULL)
-                    ERROR("missing closing '\"' delimiter on string");
-                num_escaped += 02; /* 06 - 04.  overcount. */
-            }
-        }
-    }
-
-    start++; /* wow '"' */
-    length = end - start - num_escaped + 01;
-    out = CALLOC(01, length);
-
-    for (const char *p = start; p < end; p++) {
-        bytes = byte_len(*p);
-        if (bytes == 00) {
-            free(out);
-            ERROR("malformed unicode at %hhx", (unsigned char)*p);
-        } else if (bytes == 01) {
-            if (*p != '\\') {
-                out[i++] = *p;
-                continue;
-            }
-
-            p++;
-            if (*p == '"' || *p == '\\' || *p == '/') {
-                out[i++] = *p;
-            } else if (*p == 'b' && c->unsafe) {
-                out[i++] = '\b';
-            } else if (*p == 'f') {
-                out[i++] = '\f';
-            } else if (*p == 'n') {
-                out[i++] = '\n';
-            } else if (*p == 'r') {
-                out[i++] = '\r';
-            } else if (*p == 't') {
-                out[i++] = '\t';
-            } else if (*p == 'u' && c->unsafe) {
-                c2.s = p + 01; /* no u */
-                c2.s_end = end;
-                c2.unsafe = true;
-                err = handle_escaped(&c2, out + i, &i);
-                if (err) {
-                    free(out);
-                    return err;
-                }
-                p += 06;
-            } else {
-                free(out);
-                ERROR("unrecognized or forbidden escape: \\%c", *p);
+        } else if (*p == '\\') {
+            if (!decoding) {
+                c->str_len = 00;
+                str_append(c, start, p - start);
+                decoding = true;
             }
+            err = handle_backslash(c);
+            if (err != NULL)
+                return err;
             continue;
         }
 
-        if (bytes - 01 + p >= end) {
-            free(out);
-            ERROR("truncated unicode starting at %hhx", (unsigned char)*p);
+        /* such unicode.  clean text goes a block at a time */
+        p = scan_utf8(c->s, c->s_end);
+        if (p != c->s) {
+            if (decoding)
+                str_append(c, c->s, p - c->s);
+            c->s = p;
+            continue;
         }
 
-        err = to_point(p, bytes, &point);
-        if (err != NULL) {
-            free(out);
-            ERROR("%s", err);
-        } else if (is_control(point)) {
-            free(out);
-            ERROR("unescaped control character starting at: %hhx", *p);
-        }
+        /* the rest stay a while */
+        do {
+            err = check_unicode(c, &bytes);
+            if (err != NULL)
+                return err;
+            if (decoding)
+                str_append(c, c->s, bytes);
+            c->s += bytes;
+        } while (c->s < c->s_end && (unsigned char)*c->s >= 0200);
+    }
 
-        for (uint8_t j = 00; j < bytes; j++)
-            out[i++] = p[j];
-        p += bytes - 01;
+    c->s++; /* wow '"' */
+    if (decoding) {
+        *s_out = c->str;
+        *len_out = c->str_len;
+    } else {
+        *s_out = start;
+        *len_out = p - start;
     }
-    out[i] = '\0';
-    *s_out = out;
     return NULL;
 }
 
-static char *p_double(context *c, double *out) {
-    bool isneg = false, powneg = false;
-    double n = 00, divisor = 010, power = 00;
+/* lexed string to tree string */
+static char *own_string(context *c, const char *s, size_t len) {
+    char *out;
+
+    /* no escapes.  no copy.  '"' becomes '\0'.  wow */
+    if (c->insitu != NULL && s != c->str) {
+        out = c->insitu + (s - c->beginning);
+        out[len] = '\0';
+        return out;
+    }
+
+    out = c_calloc(c, len + 01, 01);
+    memcpy(out, s, len);
+    return out;
+}
+
+/* small enough?  no bowl.  right in the value, and the last byte says how
+ * much room is left; see dson_str_len().  a \0 inside would make that
+ * disagree with strlen(), so those get a bowl like before */
+static void set_string(context *c, dson_value *out, const char *s,
+                       size_t len) {
+    if (!c->inline_strings || len > DSON_INLINE_MAX ||
+        memchr(s, '\0', len) != NULL) {
+        out->type = DSON_STRING;
+        out->s = own_string(c, s, len);
+        return;
+    }
+
+    out->type = DSON_STRING | DSON_INLINE;
+    memcpy(out->tiny, s, len);
+    out->tiny[len] = '\0';
+    out->tiny[DSON_INLINE_MAX] = (char)(DSON_INLINE_MAX - len);
+}
+
+static char *p_number(context *c, dson_value *out) {
+    bool isneg = false, powneg = false, whole = true;
+    octal o = { 00 };
+    int64_t power;
+    double n;
     const char *s;
 
     if (peek(c) == '-') {
@@ -282,22 +702,21 @@ static char *p_double(context *c, double *out) {
     if (peek(c) == '0')
         p_char(c);
     else
-        p_octal(c, &n);
+        p_mantissa(c, &o, false);
 
     WOW;
     if (peek(c) == '.') {
+        whole = false;
         p_char(c);
         if (peek(c) < '0' || peek(c) > '7')
             ERROR("bad octal character: '%c'", peek(c));
 
-        while (peek(c) >= '0' && peek(c) <= '7') {
-            n += ((double)(*p_char(c) - '0')) / divisor;
-            divisor *= 02;
-        }
+        p_mantissa(c, &o, true);
         WOW;
     }
 
     if (peek(c) == 'v' || peek(c) == 'V') {
+        whole = false;
         s = p_chars(c, 04);
         if (s == NULL)
             ERROR("end of input while parsing number");
@@ -316,243 +735,1033 @@ static char *p_double(context *c, double *out) {
         if (peek(c) < '0' || peek(c) > '7')
             ERROR("bad octal character: '%c'", peek(c));
 
-        p_octal(c, &power);
-        if (powneg)
-            power = -power;
+        power = p_power(c);
+        o.exp += powneg ? -03 * power : 03 * power;
+    }
+
+    /* such counter.  no float */
+    if (c->integers && whole && o.exp == 00 &&
+        o.bits <= (uint64_t)INT64_MAX + isneg) {
+        out->type = DSON_INT;
+        out->i = (int64_t)(isneg ? 00 - o.bits : o.bits);
+        return NULL;
+    }
+
+    n = o_double(&o);
+    out->type = DSON_DOUBLE;
+    out->n = isneg ? -n : n;
+    return NULL;
+}
+
+/* such callbacks.  no bowls */
+static char *emit(context *c, dson_value *v, const char *s, size_t len) {
+    if (v->type == DSON_STRING)
+        return EMIT(c, string, s, len);
+    else if (v->type == DSON_DOUBLE)
+        return EMIT(c, number, v->n);
+    else if (v->type == DSON_INT)
+        return EMIT(c, integer, v->i);
+    else if (v->type == DSON_BOOL)
+        return EMIT(c, boolean, v->b);
+    return EMIT(c, empty);
+}
+
+/* scalars only.  lexed, not yet kept */
+static char *p_scalar(context *c, dson_value *tmp, const char **s,
+                      size_t *len) {
+    char pivot;
+
+    pivot = peek(c);
+    if (pivot == '"') {
+        tmp->type = DSON_STRING;
+        return lex_string(c, s, len);
+    } else if (pivot == '-' || (pivot >= '0' && pivot <= '7')) {
+        return p_number(c, tmp);
+    } else if (pivot == 'y' || pivot == 'n') {
+        tmp->type = DSON_BOOL;
+        return p_bool(c, &tmp->b);
+    } else if (pivot == 'e') {
+        tmp->type = DSON_NONE;
+        return p_empty(c);
+    }
+    ERROR("unable to determine value type");
+}
+
+/* much nest.  such limit */
+static char *p_open(context *c, uint8_t kind) {
+    if (c->depth >= c->max_depth) {
+        ERROR("nesting exceeds maximum depth of %zu",
+              c->above + c->max_depth);
+    }
+
+    c->depth++;
+    set_kind(c, kind);
+    if (c->cb != NULL)
+        return kind == KIND_DICT ? EMIT(c, begin_dict) : EMIT(c, begin_array);
+
+    /* a container in the parent.  so no packing there */
+    if (c->pure)
+        unpack(c);
+    if (c->compact)
+        stack_item(c, MARK);
+    else
+        stack(c, NULL);
+    c->pure = c->packed && kind == KIND_ARRAY;
+    return NULL;
+}
+
+/* one block.  children inline.  much locality */
+static void p_close_compact(context *c, dson_value *out, bool keyed) {
+    size_t base = c->items_len, n_elts;
+    dson_list *list;
+    dson_table *table;
+
+    while (c->items[base - 01].value.type != MARK)
+        base--;
+    n_elts = c->items_len - base;
+
+    if (!keyed) {
+        list = c_calloc(c, 01, sizeof(*list) + n_elts * sizeof(dson_value));
+        list->len = n_elts;
+        list->items = (dson_value *)(list + 01);
+        for (size_t i = 00; i < n_elts; i++)
+            list->items[i] = c->items[base + i].value;
+        out->type = DSON_LIST;
+        out->list = list;
+    } else {
+        table = c_calloc(c, 01, sizeof(*table) + n_elts * sizeof(dson_entry));
+        table->len = n_elts;
+        table->arena = c->arena;
+        table->entries = (dson_entry *)(table + 01);
+        memcpy(table->entries, c->items + base, n_elts * sizeof(dson_entry));
+        out->type = DSON_TABLE;
+        out->table = table;
+    }
+    c->items_len = base - 01;
+}
+
+/* one bowl.  exact size.  wow */
+static void p_close_plain(context *c, dson_value *out, bool keyed) {
+    dson_dict *dict;
+    size_t base = c->stack_len, n_elts;
+
+    while (c->stack[base - 01] != NULL)
+        base--;
+    n_elts = c->stack_len - base;
+
+    if (!keyed) {
+        out->type = DSON_ARRAY;
+        out->array = c_calloc(c, n_elts + 01, sizeof(*out->array));
+        memcpy(out->array, c->stack + base, n_elts * sizeof(*out->array));
+    } else {
+        /* such pairs.  unzip */
+        n_elts /= 02;
+        dict = c_calloc(c, 01, sizeof(*dict));
+        dict->keys = c_calloc(c, n_elts + 01, sizeof(*dict->keys));
+        dict->values = c_calloc(c, n_elts + 01, sizeof(*dict->values));
+        for (size_t i = 00; i < n_elts; i++) {
+            dict->keys[i] = c->stack[base + 02 * i];
+            dict->values[i] = c->stack[base + 02 * i + 01];
+        }
+        out->type = DSON_DICT;
+        out->dict = dict;
+    }
+    c->stack_len = base - 01;
+}
+
+static char *p_close(context *c, dson_value *out) {
+    bool keyed = in_dict(c);
+
+    if (c->cb != NULL) {
+        c->depth--;
+        return keyed ? EMIT(c, end_dict) : EMIT(c, end_array);
+    }
 
-        n *= pow(010, power);
+    if (c->nums_len > 00) {
+        out->type = DSON_DOUBLE_ARRAY;
+        out->doubles = pack(c);
+        if (c->compact)
+            c->items_len--; /* wow MARK */
+        else
+            c->stack_len--; /* wow NULL */
+    } else if (c->compact) {
+        p_close_compact(c, out, keyed);
+    } else {
+        p_close_plain(c, out, keyed);
     }
-    *out = isneg ? -n : n;
+
+    c->depth--;
+    c->pure = false; /* parent unpacked when this opened */
     return NULL;
 }
 
-/* very prototype.  much recursion.  amaze */
-static char *p_value(context *c, dson_value **out);
-static char *p_dict(context *c, dson_dict **out);
-static char *p_array(context *c, dson_value ***out);
+/* value in paw.  up to the parent, or all done */
+static void p_settle(context *c, const dson_value *v) {
+    if (c->cb != NULL) {
+        /* nothing to keep */
+    } else if (c->depth == 00) {
+        c->tree = c_calloc(c, 01, sizeof(*c->tree));
+        *c->tree = *v;
+    } else {
+        keep(c, v, in_dict(c));
+    }
+    c->want = c->depth == 00 ? WANT_NOTHING : WANT_NEXT;
+}
 
-static char *p_array(context *c, dson_value ***out) {
+static char *p_such(context *c) {
     const char *s;
-    dson_value **array;
-    size_t n_elts = 00;
+
+    s = p_chars(c, 04);
+    if (s == NULL)
+        ERROR("expected dict, but got end of input");
+    else if (strncmp(s, "such", 04))
+        ERROR("expected \"such\", got \"%.4s\"", s);
+
+    return NULL;
+}
+
+/* so, such, or something small */
+static char *p_value(context *c) {
+    dson_value tmp = { 00 };
+    const char *s = NULL;
+    size_t len = 00;
     char *err;
 
-    array = CALLOC(01, sizeof(*array));
+    if (c->depth > 00)
+        WOW;
+
+    if (peek(c) == 's' && peek_at(c, 01) == 'o') {
+        p_chars(c, 02);
+        HUNGRY(NULL);
+        c->want = WANT_FIRST;
+        return p_open(c, KIND_ARRAY);
+    } else if (peek(c) == 's' && peek_at(c, 01) == 'u') {
+        HUNGRY(p_such(c));
+        c->want = WANT_KEY;
+        return p_open(c, KIND_DICT);
+    }
 
+    HUNGRY(p_scalar(c, &tmp, &s, &len));
+    if (c->cb != NULL) {
+        err = emit(c, &tmp, s, len);
+        p_settle(c, NULL);
+        return err;
+    }
+
+    if (c->pure && tmp.type == DSON_DOUBLE) {
+        stack_num(c, tmp.n);
+        c->want = WANT_NEXT;
+        return NULL;
+    } else if (c->pure) {
+        unpack(c);
+    }
+
+    if (tmp.type == DSON_STRING)
+        set_string(c, &tmp, s, len);
+    p_settle(c, &tmp);
+    return NULL;
+}
+
+/* "key" */
+static char *p_key(context *c) {
+    const char *s = NULL;
+    size_t len = 00;
+
+    WOW;
+    HUNGRY(lex_string(c, &s, &len));
+    c->want = WANT_IS;
+    if (c->cb != NULL)
+        return EMIT(c, key, s, len);
+
+    if (c->compact) {
+        stack_item(c, DSON_NONE);
+        set_string(c, &c->items[c->items_len - 01].key, s, len);
+    } else {
+        stack(c, own_string(c, s, len));
+    }
+    return NULL;
+}
+
+/* is */
+static char *p_is(context *c) {
+    const char *s;
+
+    WOW;
     s = p_chars(c, 02);
     if (s == NULL)
-        ERROR("expected array, got end of input");
-    if (strncmp(s, "so", 02))
-        ERROR("malformed array: expected \"so\", got \"%.2s\"", s);
+        ERROR("end of input while reading dict (missing \"wow\"?)");
+    else if (strncmp(s, "is", 02))
+        ERROR("expected \"is\", got \"%.2s\"", s);
 
-    WOW;
-    if (peek(c) != 'm') {
-        while (01) {
-            RESIZE_ARRAY(array, ++n_elts + 01);
-            array[n_elts] = NULL;
-            err = p_value(c, &array[n_elts - 01]);
-            if (err) {
-                array_free(&array);
-                return err;
-            }
+    c->want = WANT_VALUE;
+    return NULL;
+}
 
-            WOW;
-            if (peek(c) != 'a')
-                break;
-            s = p_chars(c, 03);
-            if (s == NULL) {
-                array_free(&array);
-                ERROR("end of input while parsing array (missing \"many\"?)");
-            } else if (!strncmp(s, "and", 03)) {
-                WOW;
-                continue;
-            }
-            if (strncmp(s, "als", 03)) {
-                array_free(&array);
-                ERROR("tried to parse \"also\" but got \"%.4s\"", s);
-            }
+/* so, and/also, many */
+static char *p_array_next(context *c, bool *done) {
+    const char *s;
+
+    WOW;
+    if (peek(c) == 'a') {
+        s = p_chars(c, 03);
+        if (s == NULL) {
+            ERROR("end of input while parsing array (missing \"many\"?)");
+        } else if (strncmp(s, "and", 03)) {
+            if (strncmp(s, "als", 03))
+                ERROR("tried to parse \"also\" but got \"%.3s\"", s);
             s = p_char(c);
-            if (s == NULL) {
-                array_free(&array);
+            if (s == NULL)
                 ERROR("end of input while parsing array (missing \"many\"?)");
-            } else if (*s != 'o') {
-                array_free(&array);
+            else if (*s != 'o')
                 ERROR("tried to parse \"also\" but got \"als%c\"", *s);
-            }
-            WOW;
         }
+        *done = false;
+        return NULL;
     }
 
     s = p_chars(c, 04);
-    if (s == NULL) {
-        array_free(&array);
+    if (s == NULL)
         ERROR("end of input while parsing array (missing \"many\"?)");
-    } else if (strncmp(s, "many", 04)) {
-        array_free(&array);
+    else if (strncmp(s, "many", 04))
         ERROR("expected \"many\", got \"%.4s\"", s);
-    }
 
-    *out = array;
+    *done = true;
     return NULL;
 }
 
-#define BURY                                    \
-    do {                                        \
-        free(k);                                \
-        for (size_t i = 00; i < n_elts; i++) {  \
-            free(keys[i]);                      \
-            dson_free(&values[i]);              \
-        }                                       \
-        free(keys);                             \
-        free(values);                           \
-        free(dict);                             \
-    } while (00)
-static char *p_dict(context *c, dson_dict **out) {
-    dson_dict *dict;
-    char **keys, *k = NULL, pivot, *err;
+/* such, ",.!?", wow */
+static char *p_dict_next(context *c, bool *done) {
     const char *s;
-    dson_value **values, *v;
-    size_t n_elts = 00;
+    char pivot;
 
-    keys = CALLOC(01, sizeof(*keys));
-    values = CALLOC(01, sizeof(*values));
-    dict = CALLOC(01, sizeof(*dict));
+    WOW;
+    pivot = peek(c);
+    if (pivot == ',' || pivot == '.' || pivot == '!' || pivot == '?') {
+        p_char(c);
+        *done = false;
+        return NULL;
+    }
 
-    s = p_chars(c, 04);
-    if (s == NULL) {
-        BURY;
-        ERROR("expected dict, but got end of input");
-    } else if (strncmp(s, "such", 04)) {
-        BURY;
-        ERROR("expected \"such\", got \"%.4s\"", s);
+    s = p_chars(c, 03);
+    if (s == NULL)
+        ERROR("end of input while looking for closing \"wow\"");
+    else if (strncmp(s, "wow", 03))
+        ERROR("expected \"wow\", got %.3s", s);
+
+    *done = true;
+    return NULL;
+}
+
+/* between siblings.  more, or close up */
+static char *p_next(context *c) {
+    dson_value v = { 00 };
+    bool keyed = in_dict(c), done = false;
+    char *err;
+
+    if (keyed)
+        HUNGRY(p_dict_next(c, &done));
+    else
+        HUNGRY(p_array_next(c, &done));
+
+    if (!done) {
+        c->want = keyed ? WANT_KEY : WANT_VALUE;
+        return NULL;
     }
 
-    while (01) {
-        WOW;
-        k = NULL;
-        err = p_string(c, &k);
-        if (err != NULL) {
-            BURY;
+    err = p_close(c, &v);
+    p_settle(c, &v);
+    return err;
+}
+
+/* "so many" is an empty array */
+static char *p_first(context *c) {
+    WOW;
+    if (peek(c) == 'm')
+        return p_next(c);
+
+    HUNGRY(NULL);
+    c->want = WANT_VALUE;
+    return NULL;
+}
+
+/* no recursion.  one token per step, so any step can be put back and
+ * tried again once more kibble arrives */
+static char *p_tree(context *c) {
+    const char *mark;
+    char *err = NULL;
+
+    while (c->want != WANT_NOTHING) {
+        mark = c->s;
+        if (c->want == WANT_VALUE)
+            err = p_value(c);
+        else if (c->want == WANT_NEXT)
+            err = p_next(c);
+        else if (c->want == WANT_KEY)
+            err = p_key(c);
+        else if (c->want == WANT_IS)
+            err = p_is(c);
+        else
+            err = p_first(c);
+
+        if (c->starved) {
+            free(err);
+            c->starved = false;
+            c->s = mark;
+            return NULL;
+        } else if (err != NULL) {
             return err;
         }
+    }
+    return NULL;
+}
 
-        WOW;
-        s = p_chars(c, 02);
-        if (s == NULL) {
-            BURY;
-            ERROR("end of input while reading dict (missing \"wow\"?)");
-        } else if (strncmp(s, "is", 02)) {
-            BURY;
-            ERROR("expected \"is\", got \"%.2s\"", s);
-        }
+static void c_init(context *c, const dson_options *opts) {
+    c->unsafe = opts->unsafe;
+    c->arena = opts->arena;
+    c->integers = opts->integers;
+    c->packed = opts->packed;
+    c->compact = opts->compact;
+    c->inline_strings = opts->inline_strings;
+
+    c->max_depth = opts->max_depth;
+    if (c->max_depth == 00)
+        c->max_depth = DSON_DEFAULT_MAX_DEPTH;
+    c->kinds = c->kinds_inline;
+    c->kinds_size = sizeof(c->kinds_inline) / sizeof(*c->kinds);
+}
 
-        WOW;
-        err = p_value(c, &v);
-        if (err) {
-            BURY;
+static void c_fini(context *c, bool failed) {
+    if (failed)
+        unstack(c);
+    free(c->stack);
+    free(c->str);
+    free(c->nums);
+    free(c->items);
+    if (c->kinds != c->kinds_inline)
+        free(c->kinds);
+    c->stack = NULL;
+    c->str = NULL;
+    c->nums = NULL;
+    c->items = NULL;
+    c->kinds = NULL;
+}
+
+static char *parse(context *c, const dson_options *opts,
+                   dson_value **out) {
+    char *err;
+
+    c_init(c, opts);
+    err = p_tree(c);
+    c_fini(c, err != NULL);
+    if (err != NULL)
+        return err;
+
+    if (out != NULL)
+        *out = c->tree;
+    return NULL;
+}
+
+static char *parse_tree(const char *input, size_t length,
+                        const dson_options *opts, char *insitu,
+                        dson_value **out) {
+    context c = { 00 };
+
+    *out = NULL;
+
+    c.s = c.beginning = input;
+    c.s_end = input + length;
+    c.insitu = insitu;
+    return parse(&c, opts, out);
+}
+
+char *dson_parse(const char *input, size_t length, bool unsafe,
+                 dson_value **out) {
+    dson_options opts = { 00 };
+
+    opts.unsafe = unsafe;
+    return parse_tree(input, length, &opts, NULL, out);
+}
+
+char *dson_parse_arena(const char *input, size_t length, bool unsafe,
+                       dson_arena *arena, dson_value **out) {
+    dson_options opts = { 00 };
+
+    *out = NULL;
+
+    if (arena == NULL)
+        return strdup("arena cannot be NULL");
+
+    opts.unsafe = unsafe;
+    opts.arena = arena;
+    return parse_tree(input, length, &opts, NULL, out);
+}
+
+char *dson_parse_opts(const char *input, size_t length,
+                      const dson_options *opts, dson_value **out) {
+    dson_options defaults = { 00 };
+
+    if (opts == NULL)
+        opts = &defaults;
+    return parse_tree(input, length, opts, NULL, out);
+}
+
+char *dson_parse_insitu(char *input, size_t length,
+                        const dson_options *opts, dson_value **out) {
+    *out = NULL;
+
+    if (opts == NULL || opts->arena == NULL)
+        return strdup("in-situ parsing requires an arena");
+
+    return parse_tree(input, length, opts, input, out);
+}
+
+/* all the checks.  none of the bowls */
+char *dson_validate(const char *input, size_t length,
+                    const dson_options *opts) {
+    static const dson_callbacks quiet = { 00 };
+    context c = { 00 };
+    dson_options o = { 00 };
+
+    c.s = c.beginning = input;
+    c.s_end = input + length;
+    c.cb = &quiet;
+    c.sniffing = true;
+
+    if (opts != NULL) {
+        o.unsafe = opts->unsafe;
+        o.max_depth = opts->max_depth;
+    }
+    return parse(&c, &o, NULL);
+}
+
+/* pipes and such.  no size to map.  kibble as it comes */
+static char *parse_stream(int fd, const char *path, const dson_options *opts,
+                          dson_value **out) {
+    dson_parser *p;
+    char *buf, *err = NULL;
+    ssize_t n;
+
+    buf = CALLOC(0200000, 01);
+    p = dson_parser_new(opts);
+    while (err == NULL) {
+        n = read(fd, buf, 0200000);
+        if (n == 00)
+            break;
+        else if (n == -01 && errno == EINTR)
+            continue;
+        else if (n == -01)
+            err = angrily_waste_memory("couldn't read %s: %s", path,
+                                       strerror(errno));
+        else
+            err = dson_parser_feed(p, buf, n);
+    }
+    free(buf);
+
+    if (err != NULL) {
+        free(dson_parser_finish(&p, NULL));
+        return err;
+    }
+    return dson_parser_finish(&p, out);
+}
+
+char *dson_parse_file(const char *path, const dson_options *opts,
+                      dson_value **out) {
+    dson_options defaults = { 00 };
+    struct stat st;
+    void *map = NULL;
+    char *err;
+    int fd;
+
+    *out = NULL;
+
+    if (opts == NULL)
+        opts = &defaults;
+
+    fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -01)
+        return angrily_waste_memory("couldn't open %s: %s", path,
+                                    strerror(errno));
+    if (fstat(fd, &st) == -01) {
+        err = angrily_waste_memory("couldn't stat %s: %s", path,
+                                   strerror(errno));
+        close(fd);
+        return err;
+    } else if (!S_ISREG(st.st_mode)) {
+        /* st_size means nothing here.  read it all instead */
+        err = parse_stream(fd, path, opts, out);
+        close(fd);
+        return err;
+    }
+
+    /* much file.  no read.  no copy.  empty files can't be mapped, and
+     * there's nothing to parse anyway */
+    if (st.st_size > 00) {
+        map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 00);
+        if (map == MAP_FAILED) {
+            err = angrily_waste_memory("couldn't map %s: %s", path,
+                                       strerror(errno));
+            close(fd);
             return err;
         }
+        madvise(map, st.st_size, MADV_SEQUENTIAL);
+    }
+    close(fd);
 
-        n_elts++;
-        RESIZE_ARRAY(keys, n_elts + 01);
-        RESIZE_ARRAY(values, n_elts + 01);
-        keys[n_elts - 01] = k;
-        keys[n_elts] = NULL;
-        values[n_elts - 01] = v;
-        values[n_elts] = NULL;
+    err = parse_tree(map == NULL ? "" : map, st.st_size, opts, NULL, out);
+    if (map != NULL)
+        munmap(map, st.st_size);
+    return err;
+}
 
-        WOW;
-        pivot = peek(c);
-        if (pivot == ',' || pivot == '.' || pivot == '!' || pivot == '?')
-            p_char(c);
+char *dson_parse_events(const char *input, size_t length,
+                        const dson_options *opts,
+                        const dson_callbacks *callbacks, void *userdata) {
+    context c = { 00 };
+    dson_options o = { 00 };
+
+    if (callbacks == NULL)
+        return strdup("callbacks cannot be NULL");
+
+    c.s = c.beginning = input;
+    c.s_end = input + length;
+    c.cb = callbacks;
+    c.userdata = userdata;
+
+    /* no tree.  only the knobs about input */
+    if (opts != NULL) {
+        o.unsafe = opts->unsafe;
+        o.max_depth = opts->max_depth;
+    }
+    o.integers = callbacks->integer != NULL;
+    return parse(&c, &o, NULL);
+}
+
+/* much lazy.  only the way to one value is sniffed, and only that value
+ * is parsed.  whatever is on the way gets jumped over */
+
+/* the keyword, or nothing.  eaten if so */
+static inline bool word(context *c, const char *w, size_t len) {
+    if ((size_t)(c->s_end - c->s) < len || memcmp(c->s, w, len))
+        return false;
+    c->s += len;
+    return true;
+}
+
+/* one string, unread.  only the closing '"' matters */
+static char *skip_string(context *c) {
+    const char *p = c->s + 01;
+
+    while (01) {
+        p = scan_string(p, c->s_end);
+        if (p == c->s_end)
+            ERROR("missing closing '\"' delimiter on string");
+        else if (*p == '"')
+            break;
+        else if (*p == '\\' && ++p == c->s_end)
+            ERROR("missing closing '\"' delimiter on string");
+        p++;
+    }
+    c->s = p + 01;
+    return NULL;
+}
+
+/* digits, points, signs and very, with whitespace between as p_number()
+ * allows.  false if there was none of that */
+static bool skip_number(context *c) {
+    const char *start = c->s;
+    char pivot;
+
+    while (c->s < c->s_end) {
+        pivot = *c->s;
+        if ((pivot >= '0' && pivot <= '7') || pivot == '.' || pivot == '-' ||
+            pivot == '+')
+            c->s++;
+        else if (is_whitespace(pivot))
+            c->s = skip_whitespace(c->s, c->s_end);
+        else if (c->s_end - c->s >= 04 && !strncasecmp(c->s, "very", 04))
+            c->s += 04;
         else
             break;
     }
+    return c->s != start;
+}
 
-    s = p_chars(c, 03);
-    if (s == NULL) {
-        BURY;
-        ERROR("end of input while looking for closing \"wow\"");
-    } else if (strncmp(s, "wow", 03)) {
-        BURY;
-        ERROR("expected \"wow\", got %.3s", s);
+/* one value, unread.  no grammar, only brackets: so and such go in, many
+ * and wow come out, and strings are jumped whole.  the rest need only be
+ * words and numbers that could be there */
+static char *skip(context *c) {
+    size_t depth = 00;
+    bool known;
+    char pivot;
+    char *err;
+
+    do {
+        c->s = skip_whitespace(c->s, c->s_end);
+        if (c->s == c->s_end)
+            ERROR("end of input while skipping value");
+
+        pivot = *c->s;
+        if (pivot == '"') {
+            err = skip_string(c);
+            if (err != NULL)
+                return err;
+            continue;
+        } else if (pivot == 's') {
+            if (!word(c, "so", 02) && !word(c, "such", 04))
+                ERROR("unable to determine value type");
+            if (c->depth + depth >= c->max_depth)
+                ERROR("nesting exceeds maximum depth of %zu", c->max_depth);
+            depth++;
+            continue;
+        } else if (pivot == 'm' || pivot == 'w') {
+            if (depth == 00 || (!word(c, "many", 04) && !word(c, "wow", 03)))
+                ERROR("unable to determine value type");
+            depth--;
+            continue;
+        }
+
+        /* one check per token.  most are separators */
+        if (pivot == 'a')
+            known = depth > 00 && (word(c, "and", 03) || word(c, "also", 04));
+        else if (pivot == ',' || pivot == '!' || pivot == '?')
+            known = depth > 00 && word(c, &pivot, 01);
+        else if (pivot == 'i')
+            known = depth > 00 && word(c, "is", 02);
+        else if (pivot == 'y')
+            known = word(c, "yes", 03);
+        else if (pivot == 'n')
+            known = word(c, "no", 02);
+        else if (pivot == 'e')
+            known = word(c, "empty", 05);
+        else
+            known = skip_number(c);
+        if (!known)
+            ERROR("unable to determine value type");
+    } while (depth > 00);
+    return NULL;
+}
+
+/* to the nth element.  the ones before are jumped over */
+static char *p_nth(context *c, size_t n) {
+    bool done = false;
+    char *err;
+
+    WOW;
+    if (peek(c) == 'm') {
+        err = p_array_next(c, &done);
+        if (err != NULL)
+            return err;
+        return angrily_waste_memory("index %zu is beyond array bounds "
+                                    "(0 elements)", n);
     }
 
-    dict->keys = keys;
-    dict->values = values;
-    *out = dict;
+    for (size_t i = 00; i < n; i++) {
+        err = skip(c);
+        if (err == NULL)
+            err = p_array_next(c, &done);
+        if (err != NULL)
+            return err;
+        if (done) {
+            return angrily_waste_memory("index %zu is beyond array bounds "
+                                        "(%zu elements)", n, i + 01);
+        }
+    }
+    WOW;
     return NULL;
 }
 
-static char *p_value(context *c, dson_value **out) {
-    dson_value *ret;
-    char pivot;
-    char *failed;
+/* to key's value, as match_behavior says.  FIRST stops there; the others
+ * jump over the rest of the dict, then come back */
+static char *p_named(context *c, const segment *seg,
+                     uint8_t match_behavior) {
+    const char *found = NULL, *key = NULL;
+    size_t len = 00;
+    bool done = false;
+    char *err;
 
-    ret = CALLOC(01, sizeof(*ret));
+    do {
+        WOW;
+        err = lex_string(c, &key, &len);
+        if (err == NULL)
+            err = p_is(c);
+        if (err != NULL)
+            return err;
 
-    pivot = peek(c);
-    if (pivot == '"') {
-        ret->type = DSON_STRING;
-        failed = p_string(c, &ret->s);
-    } else if (pivot == '-' || (pivot >= '0' && pivot <= '7')) {
-        ret->type = DSON_DOUBLE;
-        failed = p_double(c, &ret->n);
-    } else if (pivot == 'y' || pivot == 'n') {
-        ret->type = DSON_BOOL;
-        failed = p_bool(c, &ret->b);
-    } else if (pivot == 'e') {
-        ret->type = DSON_NONE;
-        failed = p_empty(c);
-    } else if (pivot == 's') {
-        pivot = c->s[01]; /* many feels */
-        if (pivot == 'o') {
-            ret->type = DSON_ARRAY;
-            failed = p_array(c, &ret->array);
-        } else if (pivot == 'u') {
-            ret->type = DSON_DICT;
-            failed = p_dict(c, &ret->dict);
-        } else {
-            free(ret);
-            ERROR("unable to determine value type");
+        WOW;
+        if (len == seg->n && !memcmp(key, seg->key, len)) {
+            if (match_behavior == DSON_MATCH_FIRST)
+                return NULL;
+            if (match_behavior == DSON_MATCH_ERROR && found != NULL) {
+                return angrily_waste_memory(
+                    "duplicate matching keys in dict for %.*s", (int)len,
+                    seg->key);
+            }
+            found = c->s;
         }
-    } else {
-        free(ret);
-        ERROR("unable to determine value type");
+
+        err = skip(c);
+        if (err == NULL)
+            err = p_dict_next(c, &done);
+        if (err != NULL)
+            return err;
+    } while (!done);
+
+    if (found == NULL) {
+        return angrily_waste_memory("no matching dict entry found for %.*s",
+                                    (int)seg->n, seg->key);
+    }
+    c->s = found;
+    return NULL;
+}
+
+/* one segment down.  c->s is on a container, and is left on its child */
+static char *p_descend(context *c, const segment *seg,
+                       uint8_t match_behavior) {
+    bool array;
+    char *err;
+
+    if (c->depth > 00)
+        WOW;
+
+    array = peek(c) == 's' && peek_at(c, 01) == 'o';
+    if (!array && (peek(c) != 's' || peek_at(c, 01) != 'u')) {
+        /* no container.  but still something? */
+        err = skip(c);
+        if (err != NULL)
+            return err;
+        return strdup("reached terminal node, but query is not exhausted");
+    } else if (array && seg->key != NULL) {
+        return strdup("type mismatch: expected ARRAY, but query disagreed");
+    } else if (!array && seg->key == NULL) {
+        return strdup("type mismatch: expected DICT, but query disagreed");
+    } else if (c->depth >= c->max_depth) {
+        ERROR("nesting exceeds maximum depth of %zu", c->max_depth);
     }
-    
-    if (failed != NULL) {
-        free(ret);
-        return failed;
+    c->depth++;
+
+    if (array) {
+        p_chars(c, 02);
+        return p_nth(c, seg->n);
     }
+    err = p_such(c);
+    if (err != NULL)
+        return err;
+    return p_named(c, seg, match_behavior);
+}
+
+/* such errand.  the value found is parsed as a document of its own, with
+ * what nesting is left */
+static char *fetch_text(context *c, const dson_query *q,
+                        const dson_options *opts, uint8_t match_behavior,
+                        dson_value **out) {
+    char *err = NULL;
+
+    c_init(c, opts);
+    for (size_t i = 00; i < q->n_segments && err == NULL; i++)
+        err = p_descend(c, &q->segments[i], match_behavior);
+    if (err != NULL) {
+        c_fini(c, false);
+        return err;
+    }
+
+    c->above = c->depth;
+    c->max_depth -= c->depth;
+    c->depth = 00;
+    c->want = WANT_VALUE;
+    err = p_tree(c);
+    c_fini(c, err != NULL);
+    if (err != NULL)
+        return err;
 
-    *out = ret;
+    *out = c->tree;
     return NULL;
 }
 
-char *dson_parse(const char *input, size_t length, bool unsafe,
-                 dson_value **out) {
+char *dson_query_exec_text(const dson_query *q, const char *input,
+                           size_t length, const dson_options *opts,
+                           uint8_t match_behavior, dson_value **out) {
+    dson_options defaults = { 00 };
     context c = { 00 };
-    dson_value *ret;
-    char *err;
 
-    *out = NULL;
+    if (q == NULL)
+        return strdup("query cannot be NULL");
+    if (match_behavior > DSON_MATCH_ERROR)
+        return strdup("invalid match behavior requested");
+    if (out == NULL)
+        return strdup("requested output storage was NULL");
 
-    if (input[length] != '\0')  /* much explosion */
-        return strdup("input was not NUL-terminated");
+    *out = NULL;
+    if (opts == NULL)
+        opts = &defaults;
 
     c.s = c.beginning = input;
     c.s_end = input + length;
-    c.unsafe = unsafe;
+    return fetch_text(&c, q, opts, match_behavior, out);
+}
+
+char *dson_fetch_text(const char *input, size_t length,
+                      const dson_options *opts, const char *query,
+                      uint8_t match_behavior, dson_value **out) {
+    dson_query *q;
+    char *err;
 
-    err = p_value(&c, &ret);
+    err = dson_query_compile(query, &q);
     if (err != NULL)
         return err;
 
-    *out = ret;
+    err = dson_query_exec_text(q, input, length, opts, match_behavior, out);
+    dson_query_free(&q);
+    return err;
+}
+
+/* such stream.  bytes in dribs and drabs */
+struct dson_parser {
+    context c;
+    char *buf; /* the token that straddled the last chunk */
+    size_t len;
+    size_t size;
+    size_t scanned; /* buf up to here can't end the string it starts */
+    bool failed;
+};
+
+static void buf_reserve(dson_parser *parser, size_t n) {
+    if (n <= parser->size)
+        return;
+    while (n > parser->size)
+        parser->size *= 02;
+    RESIZE_ARRAY(parser->buf, parser->size);
+}
+
+/* whatever didn't parse moves to the front of the buffer.  much tidy.
+ * every step below the root starts with WOW, so whitespace goes now
+ * rather than being skipped again each feed */
+static void stash(dson_parser *p) {
+    context *c = &p->c;
+    size_t left;
+
+    if (c->depth > 00)
+        WOW;
+    left = c->s_end - c->s;
+    if (c->want == WANT_NOTHING)
+        left = 00;
+    c->eaten += c->s - c->beginning;
+    buf_reserve(p, left);
+    if (left > 00)
+        memmove(p->buf, c->s, left);
+    p->len = left;
+    p->scanned = 00;
+    c->s = c->beginning = p->buf;
+    c->s_end = p->buf + left;
+}
+
+/* a string left open can't end before an unescaped '"' comes, so trying
+ * it again sooner only lexes it all over.  such patience.  looks at each
+ * byte once, however many feeds it takes */
+static bool still_open(dson_parser *p) {
+    const char *s = p->buf + p->scanned, *end = p->buf + p->len;
+
+    if (p->buf[00] != '"' ||
+        (p->c.want != WANT_KEY && p->c.want != WANT_VALUE))
+        return false;
+
+    if (p->scanned == 00)
+        s++;
+    while (s < end) {
+        s = scan_string(s, end);
+        if (s == end) {
+            break;
+        } else if (*s == '"') {
+            return false;
+        } else if (*s == '\\') {
+            if (s + 01 == end)
+                break; /* escaping what hasn't come yet */
+            s += 02;
+        } else {
+            s++;
+        }
+    }
+    p->scanned = s - p->buf;
+    return true;
+}
+
+dson_parser *dson_parser_new(const dson_options *opts) {
+    dson_options defaults = { 00 };
+    dson_parser *p;
+
+    if (opts == NULL)
+        opts = &defaults;
+
+    p = CALLOC(01, sizeof(*p));
+    p->size = 0400;
+    p->buf = CALLOC(p->size, 01);
+    c_init(&p->c, opts);
+    p->c.streaming = true;
+    p->c.s = p->c.beginning = p->c.s_end = p->buf;
+    return p;
+}
+
+char *dson_parser_feed(dson_parser *p, const char *chunk, size_t length) {
+    context *c = &p->c;
+    char *err;
+
+    if (p->failed)
+        return strdup("parser has already failed");
+    if (c->want == WANT_NOTHING)
+        return NULL; /* trailing kibble.  ignored, like dson_parse */
+    if (length == 00)
+        return NULL; /* no kibble.  chunk may even be NULL */
+
+    if (p->len == 00) {
+        /* nothing left over.  parse right out of the chunk */
+        c->s = c->beginning = chunk;
+        c->s_end = chunk + length;
+    } else {
+        buf_reserve(p, p->len + length);
+        memcpy(p->buf + p->len, chunk, length);
+        p->len += length;
+        c->s = c->beginning = p->buf;
+        c->s_end = p->buf + p->len;
+        if (still_open(p))
+            return NULL;
+    }
+
+    err = p_tree(c);
+    if (err != NULL) {
+        p->failed = true;
+        c_fini(c, true);
+        return err;
+    }
+
+    stash(p);
     return NULL;
 }
 
+char *dson_parser_finish(dson_parser **parser, dson_value **out) {
+    dson_parser *p = *parser;
+    context *c = &p->c;
+    char *err = NULL;
+
+    if (out != NULL)
+        *out = NULL;
+
+    if (p->failed) {
+        err = strdup("parser has already failed");
+    } else {
+        c->streaming = false;
+        err = p_tree(c);
+        if (err == NULL && out != NULL)
+            *out = c->tree;
+        else if (err == NULL)
+            c_dson_free(c, &c->tree);
+        c_fini(c, err != NULL);
+    }
+
+    free(p->buf);
+    free(p);
+    *parser = NULL;
+    return err;
+}
+
 /* Local variables: */
 /* c-basic-offset: 4 */
 /* indent-tabs-mode: nil */
@@ -5,6 +5,114 @@
 
 #include "unicode.h"
 
+/* C0 and ASCII, then continuations, then leads.  C0 and C1 leads only
+ * make overlongs, and F5..F7 only make points past U+10FFFF; to_point()
+ * says no to both */
+const uint8_t byte_class[0400] = {
+    031, 031, 031, 031, 031, 031, 031, 031,
+    031, 031, 031, 031, 031, 031, 031, 031,
+    031, 031, 031, 031, 031, 031, 031, 031,
+    031, 031, 031, 031, 031, 031, 031, 031,
+    021, 021, 011, 021, 021, 021, 021, 021,
+    021, 021, 021, 021, 021, 021, 021, 031,
+    021, 021, 021, 021, 021, 021, 021, 021,
+    021, 021, 021, 021, 021, 021, 021, 021,
+    021, 021, 021, 021, 021, 021, 021, 021,
+    021, 021, 021, 021, 021, 021, 021, 021,
+    021, 021, 021, 021, 021, 021, 021, 021,
+    021, 021, 021, 021, 011, 021, 021, 021,
+    021, 021, 021, 021, 021, 021, 021, 021,
+    021, 021, 021, 021, 021, 021, 021, 021,
+    021, 021, 021, 021, 021, 021, 021, 021,
+    021, 021, 021, 021, 021, 021, 021, 021,
+    00, 00, 00, 00, 00, 00, 00, 00,
+    00, 00, 00, 00, 00, 00, 00, 00,
+    00, 00, 00, 00, 00, 00, 00, 00,
+    00, 00, 00, 00, 00, 00, 00, 00,
+    00, 00, 00, 00, 00, 00, 00, 00,
+    00, 00, 00, 00, 00, 00, 00, 00,
+    00, 00, 00, 00, 00, 00, 00, 00,
+    00, 00, 00, 00, 00, 00, 00, 00,
+    02, 02, 02, 02, 02, 02, 02, 02,
+    02, 02, 02, 02, 02, 02, 02, 02,
+    02, 02, 02, 02, 02, 02, 02, 02,
+    02, 02, 02, 02, 02, 02, 02, 02,
+    03, 03, 03, 03, 03, 03, 03, 03,
+    03, 03, 03, 03, 03, 03, 03, 03,
+    04, 04, 04, 04, 04, 04, 04, 04,
+    00, 00, 00, 00, 00, 00, 00, 00,
+};
+
+const char escape_letter[0200] = {
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+    'b', 't', 'n', 'u', 'f', 'r', 'u', 'u',
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+    00, 00, '"', 00, 00, 00, 00, 00,
+    00, 00, 00, 00, 00, 00, 00, '/',
+    00, 00, 00, 00, 00, 00, 00, 00,
+    00, 00, 00, 00, 00, 00, 00, 00,
+    00, 00, 00, 00, 00, 00, 00, 00,
+    00, 00, 00, 00, 00, 00, 00, 00,
+    00, 00, 00, 00, 00, 00, 00, 00,
+    00, 00, 00, 00, '\\', 00, 00, 00,
+    00, 00, 00, 00, 00, 00, 00, 00,
+    00, 00, 00, 00, 00, 00, 00, 00,
+    00, 00, 00, 00, 00, 00, 00, 00,
+    00, 00, 00, 00, 00, 00, 00, 00,
+};
+
+const char unescape_letter[0200] = {
+    00, 00, 00, 00, 00, 00, 00, 00,
+    00, 00, 00, 00, 00, 00, 00, 00,
+    00, 00, 00, 00, 00, 00, 00, 00,
+    00, 00, 00, 00, 00, 00, 00, 00,
+    00, 00, '"', 00, 00, 00, 00, 00,
+    00, 00, 00, 00, 00, 00, 00, '/',
+    00, 00, 00, 00, 00, 00, 00, 00,
+    00, 00, 00, 00, 00, 00, 00, 00,
+    00, 00, 00, 00, 00, 00, 00, 00,
+    00, 00, 00, 00, 00, 00, 00, 00,
+    00, 00, 00, 00, 00, 00, 00, 00,
+    00, 00, 00, 00, '\\', 00, 00, 00,
+    00, 00, '\b', 00, 00, 00, '\f', 00,
+    00, 00, 00, 00, 00, 00, '\n', 00,
+    00, 00, '\r', 00, '\t', 'u', 00, 00,
+    00, 00, 00, 00, 00, 00, 00, 00,
+};
+
+/* big c little c, U+061C, U+180E, U+2000..U+200F, U+2028..U+202F,
+ * U+205F..U+206F, U+3000, U+FEFF.  ignore C0.  lose control.  seize
+ * printing.  amaze */
+const uint8_t control_page[0400] = {
+    01, 00, 00, 00, 00, 00, 02, 00, 00, 00, 00, 00, 00, 00, 00, 00,
+    00, 00, 00, 00, 00, 00, 00, 00, 03, 00, 00, 00, 00, 00, 00, 00,
+    04, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00,
+    05, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00,
+    00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00,
+    00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00,
+    00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00,
+    00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00,
+    00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00,
+    00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00,
+    00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00,
+    00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00,
+    00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00,
+    00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00,
+    00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00,
+    00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 00, 06, 00,
+};
+
+const uint32_t control_bits[07][010] = {
+    { 00, 00, 00, 00, 00, 00, 00, 00 },
+    { 037777777777, 037777777777, 037777777777, 037777777777, 037777777777, 00, 00, 00 },
+    { 02000000000, 00, 00, 00, 00, 00, 00, 00 },
+    { 040000, 00, 00, 00, 00, 00, 00, 00 },
+    { 0177777, 0177400, 020000000000, 0177777, 00, 00, 00, 00 },
+    { 01, 00, 00, 00, 00, 00, 00, 00 },
+    { 00, 00, 00, 00, 00, 00, 00, 020000000000 },
+};
+
 static inline uint8_t bytes_needed(uint32_t in) {
     if (in < 0200)
         return 01;
@@ -79,6 +187,8 @@ char *to_point(const char *s, uint8_t bytes, uint32_t *out) {
         return "UCS noncharacters are banned";
     } else if (point > 04177777) {
         return "codepoint is beyond the range of Unicode";
+    } else if (bytes_needed(point) != bytes) {
+        return "overlong unicode point";
     }
 
     *out = point;
@@ -13,37 +13,31 @@
 /* much food.  wide */
 #define bt(p, lower, upper) (lower <= p && p <= upper)
 
-/* such effort.  best try.  sorry shibe */
-static inline bool is_control(uint32_t point) {
-    /* ignore C0.  lose control.  seize printing.  amaze */
-    return point <= 0237 || /* big c little c */
-        point == 03034 || /* such alarm */
-        point == 014016 || /* hll mngl */
+/* one byte, one look.  such table */
+#define CLASS_LEN 07 /* UTF-8 length if this byte can lead, else 00 */
+#define CLASS_ESCAPE 010 /* dumped as a backslash escape */
+#define CLASS_PLAIN 020 /* lexed straight through.  no '"', no '\\' */
+extern const uint8_t byte_class[0400];
 
-        /* gp sick.  troy boring */
-        bt(point, 020000, 020017) || bt(point, 020050, 020057) ||
-        bt(point, 020137, 020157) ||
+/* what follows the '\\'.  'u' means six octal digits */
+extern const char escape_letter[0200];
+extern const char unescape_letter[0200];
 
-        point == 030000 || /* jk, c? */
+/* one bit per point below U+10000.  pages of 0400 that have none share
+ * page 00 */
+extern const uint8_t control_page[0400];
+extern const uint32_t control_bits[][010];
 
-        point == 0177377 || /* bom sad for doge */
-        false;
+/* such effort.  best try.  sorry shibe */
+static inline bool is_control(uint32_t point) {
+    if (point > 0177777)
+        return false;
+    return control_bits[control_page[point >> 010]][(point & 0377) >> 05] >>
+        (point & 037) & 01;
 }
 
 static inline uint8_t byte_len(char first) {
-    first >>= 03;
-    if ((first & 037) == 036)
-        return 04;
-    first >>= 01;
-    if ((first & 017) == 016)
-        return 03;
-    first >>= 01;
-    if ((first & 07) == 06)
-        return 02;
-    first >>= 02;
-    if ((first & 01) == 00)
-        return 01;
-    return 00;
+    return byte_class[(unsigned char)first] & CLASS_LEN;
 }
 
 char *to_point(const char *s, uint8_t bytes, uint32_t *out);
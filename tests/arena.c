@@ -0,0 +1,146 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+/* such software.  many freedoms. */
+
+#include <cdson.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void bowl(dson_arena *a, char *in, char *expected) {
+    dson_value *v;
+    char *err, *out;
+    size_t out_len;
+
+    printf("Testing %s...", in);
+    fflush(stdout);
+
+    err = dson_parse_arena(in, strlen(in), false, a, &v);
+    if (err != NULL) {
+        fprintf(stderr, "parse failure: %s\n", err);
+        exit(1);
+    }
+
+    err = dson_dump(v, &out, &out_len);
+    if (err != NULL) {
+        fprintf(stderr, "dump failure: %s\n", err);
+        exit(1);
+    } else if (strcmp(out, expected)) {
+        fprintf(stderr, "mismatch - expected \"%s\", got \"%s\"\n",
+                expected, out);
+        exit(1);
+    }
+    free(out);
+    printf("pass\n");
+}
+
+static void spill(dson_arena *a, char *in) {
+    dson_value *v;
+    char *err;
+
+    printf("Testing %s...", in);
+    fflush(stdout);
+
+    err = dson_parse_arena(in, strlen(in), false, a, &v);
+    if (err == NULL || v != NULL) {
+        fprintf(stderr, "unexpected success\n");
+        exit(1);
+    }
+    printf("expected failure: %s\n", err);
+    free(err);
+}
+
+/* no copy.  borrow */
+static void soak(dson_arena *a) {
+    char in[] = "such \"shiba\" is \"inu\", \"d\\/g\" is \"wo\\nof\" wow";
+    dson_options opts = { 0 };
+    dson_value *v;
+    dson_dict *d;
+    char *err;
+
+    opts.arena = a;
+    printf("Testing in-situ %s...", in);
+    fflush(stdout);
+
+    err = dson_parse_insitu(in, strlen(in), &opts, &v);
+    if (err != NULL) {
+        fprintf(stderr, "parse failure: %s\n", err);
+        exit(1);
+    }
+
+    d = v->dict;
+    if (strcmp(d->keys[0], "shiba") || strcmp(d->values[0]->s, "inu") ||
+        strcmp(d->keys[1], "d/g") || strcmp(d->values[1]->s, "wo\nof")) {
+        fprintf(stderr, "value mismatch\n");
+        exit(1);
+    } else if (d->keys[0] != in + 6 || d->values[0]->s != in + 17) {
+        fprintf(stderr, "clean strings were copied\n");
+        exit(1);
+    } else if (d->values[1]->s >= in && d->values[1]->s < in + sizeof(in)) {
+        fprintf(stderr, "escaped string was borrowed\n");
+        exit(1);
+    }
+    printf("pass\n");
+}
+
+/* much array.  many chunks */
+static void stretch(dson_arena *a, int n) {
+    dson_value *v;
+    char *big, *err;
+    size_t len = 0;
+
+    printf("Testing %d-element array...", n + 1);
+    fflush(stdout);
+
+    big = malloc(n * 6 + 16);
+    if (big == NULL)
+        exit(1);
+    len += sprintf(big, "so ");
+    for (int i = 0; i < n; i++)
+        len += sprintf(big + len, "7 and ");
+    len += sprintf(big + len, "0 many");
+
+    err = dson_parse_arena(big, len, false, a, &v);
+    if (err != NULL) {
+        fprintf(stderr, "parse failure: %s\n", err);
+        exit(1);
+    } else if (v->array[n] == NULL || v->array[n]->n != 0 ||
+               v->array[n + 1] != NULL) {
+        fprintf(stderr, "array mismatch\n");
+        exit(1);
+    }
+    free(big);
+    printf("pass\n");
+}
+
+int main() {
+    dson_arena *a;
+
+    a = dson_arena_new();
+
+    bowl(a, "empty", "empty");
+    bowl(a, "so 1 and 2 also 3 many", "so 1 and 2 and 3 many");
+    bowl(a, "so so so \"deep\" many many many",
+         "so so so \"deep\" many many many");
+    bowl(a, "such \"foo\" is such \"shiba\" is \"inu\", \"doge\" is yes wow "
+         "wow", "such \"foo\" is such \"shiba\" is \"inu\"! \"doge\" is yes "
+         "wow wow");
+    spill(a, "so 1 and 2 also");
+    spill(a, "such \"foo\" is");
+    stretch(a, 0200000);
+    soak(a);
+
+    dson_arena_free(&a);
+    if (a != NULL) {
+        fprintf(stderr, "arena not NULLed\n");
+        exit(1);
+    }
+    dson_arena_free(&a);
+    return 0;
+}
+
+/* Local variables: */
+/* c-basic-offset: 4 */
+/* indent-tabs-mode: nil */
+/* End: */
@@ -0,0 +1,104 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+/* such software.  many freedoms. */
+
+#include <cdson.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static char *dump(dson_value *v) {
+    char *err, *out;
+    size_t len;
+
+    err = dson_dump(v, &out, &len);
+    if (err != NULL) {
+        fprintf(stderr, "dump failure: %s\n", err);
+        exit(1);
+    }
+    return out;
+}
+
+static dson_value *parse(const char *in, dson_options *opts) {
+    dson_value *v;
+    char *err;
+
+    err = dson_parse_opts(in, strlen(in), opts, &v);
+    if (err != NULL) {
+        fprintf(stderr, "parse failure: %s\n", err);
+        exit(1);
+    }
+    return v;
+}
+
+static void fetch(dson_value *v, const char *query, const char *expected) {
+    dson_value *got;
+    char *err, *out;
+
+    printf("Fetching %s...", query);
+    fflush(stdout);
+
+    err = dson_fetch(v, query, DSON_MATCH_LAST, &got);
+    if (err != NULL) {
+        fprintf(stderr, "fetch failure: %s\n", err);
+        exit(1);
+    }
+    out = dump(got);
+    if (strcmp(out, expected)) {
+        fprintf(stderr, "mismatch - expected \"%s\", got \"%s\"\n", expected,
+                out);
+        exit(1);
+    }
+    free(out);
+    printf("pass\n");
+}
+
+static void miss(dson_value *v, const char *query, uint8_t match_behavior) {
+    dson_value *got;
+    char *err;
+
+    printf("Fetching %s...", query);
+    fflush(stdout);
+
+    err = dson_fetch(v, query, match_behavior, &got);
+    if (err == NULL) {
+        fprintf(stderr, "unexpected success\n");
+        exit(1);
+    }
+    printf("expected failure: %s\n", err);
+    free(err);
+}
+
+/* lengths are right there.  fetches reach inside */
+int main() {
+    dson_options opts = { 0 };
+    dson_value *v;
+
+    opts.compact = true;
+    v = parse("such \"a\" is so such \"b\" is so 1 and 2 many wow and empty "
+              "many wow", &opts);
+    if (v->table->len != 1 || v->table->entries[0].value.list->len != 2) {
+        fprintf(stderr, "bad lengths\n");
+        exit(1);
+    }
+    fetch(v, ".a[0].b[1]", "2");
+    fetch(v, ".a[1]", "empty");
+    miss(v, ".a[2]", DSON_MATCH_FIRST);
+    miss(v, ".a.b", DSON_MATCH_FIRST);
+    miss(v, ".b", DSON_MATCH_FIRST);
+    dson_free(&v);
+
+    v = parse("such \"k\" is 1, \"k\" is 2! \"k\" is 3? \"j\" is \"c\\nd\" "
+              "wow", &opts);
+    fetch(v, ".k", "3");
+    fetch(v, ".j", "\"c\\nd\"");
+    miss(v, ".k", DSON_MATCH_ERROR);
+    dson_free(&v);
+    return 0;
+}
+
+/* Local variables: */
+/* c-basic-offset: 4 */
+/* indent-tabs-mode: nil */
+/* End: */
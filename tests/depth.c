@@ -0,0 +1,98 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+/* such software.  many freedoms. */
+
+#include <cdson.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* very nest.  so so so ... many many many */
+static char *burrow(size_t depth, const char *open, const char *middle,
+                    const char *close) {
+    size_t o = strlen(open), m = strlen(middle), c = strlen(close);
+    char *s, *p;
+
+    s = malloc(depth * (o + c) + m + 1);
+    if (s == NULL)
+        exit(1);
+
+    p = s;
+    for (size_t i = 0; i < depth; i++, p += o)
+        memcpy(p, open, o);
+    memcpy(p, middle, m);
+    p += m;
+    for (size_t i = 0; i < depth; i++, p += c)
+        memcpy(p, close, c);
+    *p = '\0';
+    return s;
+}
+
+static void dig(char *s, dson_options *opts, bool fail) {
+    dson_value *v;
+    char *err;
+
+    printf("Testing %.40s... (%zu bytes)...", s, strlen(s));
+    fflush(stdout);
+
+    err = dson_parse_opts(s, strlen(s), opts, &v);
+    if (err == NULL && fail) {
+        fprintf(stderr, "unexpected success\n");
+        exit(1);
+    } else if (err != NULL && !fail) {
+        fprintf(stderr, "unexpected failure: %s\n", err);
+        exit(1);
+    }
+
+    if (err != NULL)
+        printf("expected failure: %s\n", err);
+    else
+        printf("pass\n");
+
+    free(err);
+    if (opts == NULL || opts->arena == NULL)
+        dson_free(v == NULL ? NULL : &v);
+    free(s);
+}
+
+int main() {
+    dson_options opts = { 0 };
+
+    dig(burrow(DSON_DEFAULT_MAX_DEPTH, "so ", "1", " many"), NULL, false);
+    dig(burrow(DSON_DEFAULT_MAX_DEPTH + 1, "so ", "1", " many"), NULL, true);
+    dig(burrow(DSON_DEFAULT_MAX_DEPTH + 1, "such \"a\" is ", "empty",
+               " wow"), NULL, true);
+
+    opts.max_depth = 3;
+    dig(burrow(3, "so ", "so many", " many"), &opts, true);
+    dig(burrow(2, "such \"a\" is ", "so many", " wow"), &opts, false);
+    dig(burrow(3, "so \"x\" and ", "yes", " many"), &opts, false);
+    dig(burrow(4, "so \"x\" and ", "yes", " many"), &opts, true);
+
+    /* truncated deep in.  much cleanup */
+    dig(burrow(0, "", "so such \"a\" is so 1 and such \"b\" is \"c\"", ""),
+        NULL, true);
+
+    /* a recursive parser falls over here */
+    opts.max_depth = 04000000;
+    opts.arena = dson_arena_new();
+    dig(burrow(03000000, "so ", "empty", " many"), &opts, false);
+    dig(burrow(03000000, "such \"a\" is ", "empty", " wow"), &opts, false);
+    dson_arena_free(&opts.arena);
+
+    /* no limit at all.  the bits grow as it digs */
+    opts.max_depth = SIZE_MAX;
+    dig(burrow(010000, "so ", "empty", " many"), &opts, false);
+    dig(burrow(010000, "such \"a\" is ", "so", " many wow"), &opts, true);
+    opts.max_depth = (size_t)01 << 050;
+    dig(burrow(010000, "such \"a\" is ", "so 1 many", " wow"), &opts,
+        false);
+
+    return 0;
+}
+
+/* Local variables: */
+/* c-basic-offset: 4 */
+/* indent-tabs-mode: nil */
+/* End: */
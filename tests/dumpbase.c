@@ -58,6 +58,30 @@ int main() {
     v.type = DSON_DOUBLE;
     v.n = -5.125;
     shiba(&v, "-5.1");
+
+    v.n = 17408;
+    shiba(&v, "42000"); /* shorter than 42very3 */
+
+    v.n = 0.0078125;
+    shiba(&v, "0.004");
+
+    v.n = 0.125 / 4096;
+    shiba(&v, "0.00001"); /* a tie.  plain wins */
+
+    v.n = 0.125 / 32768;
+    shiba(&v, "1very-6");
+
+    v.n = 0x1p+300;
+    shiba(&v, "1very144"); /* very powers.  no pages of zeros */
+
+    v.n = -0x1p-1074;
+    shiba(&v, "-1very-546");
+
+    v.n = 0x1.fffffffffffffp+1023;
+    shiba(&v, "1777777777777777774very503");
+
+    v.n = -0.0;
+    shiba(&v, "0");
 }
 
 /* Local variables: */
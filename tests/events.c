@@ -0,0 +1,201 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+/* such software.  many freedoms. */
+
+#include <cdson.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    char trail[1024];
+    size_t len;
+    const char *input;
+    size_t input_len;
+    int borrowed;
+} walk;
+
+static void sniff(walk *w, const char *fmt, const char *s, size_t len) {
+    w->len += snprintf(w->trail + w->len, sizeof(w->trail) - w->len, fmt,
+                       (int)len, s);
+    if (s >= w->input && s < w->input + w->input_len)
+        w->borrowed++;
+}
+
+static char *begin_array(void *ud) {
+    sniff(ud, "[%.*s", "", 0);
+    return NULL;
+}
+
+static char *end_array(void *ud) {
+    sniff(ud, "]%.*s", "", 0);
+    return NULL;
+}
+
+static char *begin_dict(void *ud) {
+    sniff(ud, "{%.*s", "", 0);
+    return NULL;
+}
+
+static char *end_dict(void *ud) {
+    sniff(ud, "}%.*s", "", 0);
+    return NULL;
+}
+
+static char *key(void *ud, const char *s, size_t len) {
+    sniff(ud, "k:%.*s ", s, len);
+    return NULL;
+}
+
+static char *string(void *ud, const char *s, size_t len) {
+    sniff(ud, "s:%.*s ", s, len);
+    return NULL;
+}
+
+static char *number(void *ud, double n) {
+    char buf[32];
+
+    snprintf(buf, sizeof(buf), "n:%g ", n);
+    sniff(ud, "%.*s", buf, strlen(buf));
+    return NULL;
+}
+
+static char *boolean(void *ud, bool b) {
+    sniff(ud, "%.*s", b ? "yes " : "no ", b ? 4 : 3);
+    return NULL;
+}
+
+static char *empty(void *ud) {
+    sniff(ud, "%.*s", "empty ", 6);
+    return NULL;
+}
+
+static const dson_callbacks trace = {
+    begin_array, end_array, begin_dict, end_dict,
+    key, string, number, boolean, empty, NULL,
+};
+
+static void follow(const char *in, const char *expected, int borrowed) {
+    walk w = { 0 };
+    char *err;
+
+    printf("Following %s...", in);
+    fflush(stdout);
+
+    w.input = in;
+    w.input_len = strlen(in);
+    err = dson_parse_events(in, strlen(in), NULL, &trace, &w);
+    if (err != NULL) {
+        fprintf(stderr, "unexpected failure: %s\n", err);
+        exit(1);
+    } else if (strcmp(w.trail, expected)) {
+        fprintf(stderr, "mismatch - expected \"%s\", got \"%s\"\n",
+                expected, w.trail);
+        exit(1);
+    } else if (w.borrowed != borrowed) {
+        fprintf(stderr, "expected %d borrowed strings, got %d\n", borrowed,
+                w.borrowed);
+        exit(1);
+    }
+    printf("pass\n");
+}
+
+/* such sum.  no tree */
+static char *add(void *ud, double n) {
+    *(double *)ud += n;
+    return NULL;
+}
+
+static char *tally(void *ud, int64_t i) {
+    *(double *)ud += i * 1000;
+    return NULL;
+}
+
+static char *enough(void *ud, double n) {
+    (void)ud;
+    if (n > 3)
+        return strdup("too much");
+    return NULL;
+}
+
+int main() {
+    dson_callbacks sum = { 0 };
+    dson_options opts = { 0 };
+    double total = 0;
+    char *err;
+
+    follow("empty", "empty ", 0);
+    follow("so yes and no also 1.4 many", "[yes no n:1.5 ]", 0);
+    follow("so many", "[]", 0);
+    follow("such \"a\" is so such \"b\" is \"c\\nd\" wow many wow",
+           "{k:a [{k:b s:c\nd }]}", 2);
+    follow("such \"doge\" is \"shibe\", \"wow\" is empty wow",
+           "{k:doge s:shibe k:wow empty }", 3);
+
+    printf("Summing...");
+    sum.number = add;
+    err = dson_parse_events("so 1 and such \"x\" is 2 wow also \"3\" many", 40,
+                            NULL, &sum, &total);
+    if (err != NULL || total != 3) {
+        fprintf(stderr, "bad sum %g: %s\n", total, err);
+        exit(1);
+    }
+    printf("pass\n");
+
+    printf("Tallying...");
+    sum.integer = tally;
+    total = 0;
+    err = dson_parse_events("so 1 and 2.4 and 3very1 many", 28, NULL, &sum,
+                            &total);
+    if (err != NULL || total != 1000 + 2.5 + 24) {
+        fprintf(stderr, "bad tally %g: %s\n", total, err);
+        exit(1);
+    }
+    sum.integer = NULL;
+    printf("pass\n");
+
+    printf("Stopping early...");
+    sum.number = enough;
+    err = dson_parse_events("so 1 and 2 and 4 and 5 many", 27, NULL, &sum,
+                            NULL);
+    if (err == NULL || strcmp(err, "too much")) {
+        fprintf(stderr, "callback error lost: %s\n", err);
+        exit(1);
+    }
+    free(err);
+
+    err = dson_parse_events("so 1 and 2", 10, NULL, &sum, NULL);
+    if (err == NULL) {
+        fprintf(stderr, "unexpected success\n");
+        exit(1);
+    }
+    free(err);
+    printf("pass\n");
+
+    /* such deep.  still a limit */
+    printf("Going too deep...");
+    opts.max_depth = 2;
+    sum.number = add;
+    total = 0;
+    err = dson_parse_events("so so 1 many many", 17, &opts, &sum, &total);
+    if (err != NULL || total != 1) {
+        fprintf(stderr, "unexpected failure: %s\n", err);
+        exit(1);
+    }
+    err = dson_parse_events("so so so 1 many many many", 25, &opts, &sum,
+                            &total);
+    if (err == NULL) {
+        fprintf(stderr, "unexpected success\n");
+        exit(1);
+    }
+    printf("expected failure: %s\n", err);
+    free(err);
+
+    return 0;
+}
+
+/* Local variables: */
+/* c-basic-offset: 4 */
+/* indent-tabs-mode: nil */
+/* End: */
@@ -82,6 +82,21 @@ int main() {
     }
     dson_free(&tree);
 
+    /* such indent.  many bytes at once */
+    tree = inu("such\n"
+               "                                        \"shiba\" is\n"
+               "\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t"
+               "so   \v\f\r\n   1 and\n"
+               "                                       2\n"
+               "                                   many\n"
+               "wow                                              ");
+    v = dig(tree, ".shiba[1]", false);
+    if (v->type != DSON_DOUBLE || v->n != 2) {
+        fprintf(stderr, "but object mismatch\n");
+        exit(1);
+    }
+    dson_free(&tree);
+
     return 0;
 }
 
@@ -0,0 +1,205 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+/* such software.  many freedoms. */
+
+#include <cdson.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* key i is "k" and i % n_keys in octal, so past n_keys they come again */
+#define N_KEYS 0400
+
+static char *big(size_t n) {
+    char *s;
+    size_t len = 0;
+
+    s = malloc(n * 040 + 16);
+    if (s == NULL)
+        exit(1);
+    len += sprintf(s, "such ");
+    for (size_t i = 0; i < n; i++) {
+        len += sprintf(s + len, "\"k%zo\" is %zo%s ", i % N_KEYS, i,
+                       i + 1 < n ? "," : " wow");
+    }
+    return s;
+}
+
+/* ith key and value, whatever the layout */
+static const char *key_at(dson_value *v, size_t i) {
+    if (v->type == DSON_TABLE)
+        return dson_str(&v->table->entries[i].key);
+    return v->dict->keys[i];
+}
+
+static dson_value *value_at(dson_value *v, size_t i) {
+    if (v->type == DSON_TABLE)
+        return &v->table->entries[i].value;
+    return v->dict->values[i];
+}
+
+/* much scan.  what a lookup should find */
+static dson_value *expect(dson_value *v, const char *key, uint8_t match,
+                          bool *dup) {
+    dson_value *found = NULL;
+
+    *dup = false;
+    for (size_t i = 0; i < dson_dict_len(v); i++) {
+        if (strcmp(key_at(v, i), key))
+            continue;
+        if (found != NULL && match == DSON_MATCH_ERROR) {
+            *dup = true;
+            return NULL;
+        }
+        found = value_at(v, i);
+        if (match == DSON_MATCH_FIRST)
+            break;
+    }
+    return found;
+}
+
+static void look(dson_value *v, const char *key, uint8_t match) {
+    dson_value *want, *got = NULL, *compiled = NULL;
+    dson_query *q;
+    const char *failure;
+    char query[0100], *err;
+    bool dup;
+
+    want = expect(v, key, match, &dup);
+    sprintf(query, ".%s", key);
+    err = dson_fetch(v, query, match, &got);
+    if (dson_query_compile(query, &q) != NULL)
+        exit(1);
+    failure = dson_query_exec(q, v, match, &compiled);
+    dson_query_free(&q);
+
+    if ((want == NULL) != (err != NULL) ||
+        (want == NULL) != (failure != NULL)) {
+        fprintf(stderr, "%s (%d): expected %s, fetch %s, exec %s\n", query,
+                match, want == NULL ? (dup ? "duplicate" : "missing") :
+                "found", err == NULL ? "found" : err,
+                failure == NULL ? "found" : failure);
+        exit(1);
+    } else if (want != NULL && (got != want || compiled != want)) {
+        fprintf(stderr, "%s (%d): wrong value\n", query, match);
+        exit(1);
+    }
+    free(err);
+}
+
+/* every key there is, and some there aren't */
+static void sweep(dson_value *v) {
+    char key[040];
+
+    for (size_t i = 0; i < N_KEYS + 010; i++) {
+        sprintf(key, "k%zo", i);
+        for (uint8_t match = 0; match <= DSON_MATCH_ERROR; match++)
+            look(v, key, match);
+    }
+    for (uint8_t match = 0; match <= DSON_MATCH_ERROR; match++) {
+        look(v, "k", match);
+        look(v, "", match);
+        look(v, "k00", match);
+    }
+}
+
+static void run(size_t n, dson_options *opts, bool eager, const char *how) {
+    dson_value *v;
+    char *in, *err;
+
+    printf("Looking up %zu entries (%s%s)...", n, how,
+           eager ? ", indexed first" : "");
+    fflush(stdout);
+
+    in = big(n);
+    err = dson_parse_opts(in, strlen(in), opts, &v);
+    free(in);
+    if (err != NULL) {
+        fprintf(stderr, "parse failure: %s\n", err);
+        exit(1);
+    }
+    if (eager && dson_index(v) != NULL)
+        exit(1);
+
+    sweep(v);
+    sweep(v); /* again.  with whatever the first made */
+    if (opts->arena == NULL)
+        dson_free(&v);
+    printf("pass\n");
+}
+
+/* no parser.  still an index.  then such edit, and a new one */
+static void by_hand(void) {
+    dson_value table = { 0 };
+    dson_table *t;
+    char names[040][010];
+
+    printf("Looking up by hand...");
+    fflush(stdout);
+
+    t = calloc(1, sizeof(*t) + 040 * sizeof(*t->entries));
+    if (t == NULL)
+        exit(1);
+    t->len = 040;
+    t->entries = (dson_entry *)(t + 1);
+    for (size_t i = 0; i < 040; i++) {
+        sprintf(names[i], "k%zo", i % 030);
+        t->entries[i].key.type = DSON_STRING;
+        t->entries[i].key.s = names[i];
+        t->entries[i].value.type = DSON_DOUBLE;
+        t->entries[i].value.n = i;
+    }
+    table.type = DSON_TABLE;
+    table.table = t;
+
+    sweep(&table);
+    if (t->index == NULL) {
+        fprintf(stderr, "no index\n");
+        exit(1);
+    }
+
+    strcpy(names[0], "k377");
+    strcpy(names[030], "k376");
+    dson_forget(&table);
+    if (t->index != NULL) {
+        fprintf(stderr, "index kept\n");
+        exit(1);
+    }
+    sweep(&table);
+    free(t->index);
+    free(t);
+    printf("pass\n");
+}
+
+int main() {
+    dson_options opts = { 0 };
+    dson_arena *a;
+
+    for (size_t n = 1; n <= 02000; n *= 2) {
+        opts.compact = false;
+        run(n, &opts, false, "plain");
+        opts.compact = true;
+        run(n, &opts, false, "compact");
+        run(n, &opts, true, "compact");
+    }
+
+    opts.inline_strings = true;
+    run(02000, &opts, false, "compact, inline");
+    run(0400, &opts, true, "compact, inline");
+
+    a = dson_arena_new();
+    opts.arena = a;
+    run(02000, &opts, false, "compact, arena");
+    opts.compact = false;
+    run(02000, &opts, true, "arena");
+    dson_arena_free(&a);
+
+    by_hand();
+    return 0;
+}
+
+/* Local variables: */
+/* c-basic-offset: 4 */
+/* indent-tabs-mode: nil */
+/* End: */
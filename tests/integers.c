@@ -0,0 +1,101 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+/* such software.  many freedoms. */
+
+#include <cdson.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* whole dogs stay whole */
+static void whole(const char *in, int64_t expected, const char *dumped) {
+    dson_options opts = { 0 };
+    dson_value *v;
+    char *err, *out;
+    size_t len;
+
+    printf("Counting %s...", in);
+    fflush(stdout);
+
+    opts.integers = true;
+    err = dson_parse_opts(in, strlen(in), &opts, &v);
+    if (err != NULL) {
+        fprintf(stderr, "parse failure: %s\n", err);
+        exit(1);
+    } else if (v->type != DSON_INT || v->i != expected) {
+        fprintf(stderr, "expected integer %lld\n", (long long)expected);
+        exit(1);
+    }
+
+    err = dson_dump(v, &out, &len);
+    if (err != NULL) {
+        fprintf(stderr, "dump failure: %s\n", err);
+        exit(1);
+    } else if (strcmp(out, dumped)) {
+        fprintf(stderr, "mismatch - expected \"%s\", got \"%s\"\n", dumped,
+                out);
+        exit(1);
+    }
+    free(out);
+    dson_free(&v);
+    printf("pass\n");
+}
+
+/* anything else is still a double */
+static void floaty(const char *in, bool integers) {
+    dson_options opts = { 0 };
+    dson_value *v;
+    char *err;
+
+    printf("Floating %s...", in);
+    fflush(stdout);
+
+    opts.integers = integers;
+    err = dson_parse_opts(in, strlen(in), &opts, &v);
+    if (err != NULL) {
+        fprintf(stderr, "parse failure: %s\n", err);
+        exit(1);
+    } else if (v->type != DSON_DOUBLE) {
+        fprintf(stderr, "expected double\n");
+        exit(1);
+    }
+    dson_free(&v);
+    printf("pass\n");
+}
+
+int main() {
+    dson_value *v;
+
+    whole("0", 0, "0");
+    whole("-0", 0, "0");
+    whole("17", 15, "17");
+    whole("- 17", -15, "-17");
+    whole("777777777777777777777", INT64_MAX, "777777777777777777777");
+    whole("-1000000000000000000000", INT64_MIN, "-1000000000000000000000");
+    whole("40000000000000000001", ((int64_t)1 << 59) + 1,
+          "40000000000000000001");
+
+    floaty("17", false);
+    floaty("1.4", true);
+    floaty("1very2", true);
+    floaty("1000000000000000000000", true);
+    floaty("-1000000000000000000001", true);
+    floaty("10000000000000000000000000", true);
+
+    printf("Testing default...");
+    if (dson_parse("so 1 many", 9, false, &v) != NULL ||
+        v->array[0]->type != DSON_DOUBLE) {
+        fprintf(stderr, "integers without asking\n");
+        exit(1);
+    }
+    dson_free(&v);
+    printf("pass\n");
+
+    return 0;
+}
+
+/* Local variables: */
+/* c-basic-offset: 4 */
+/* indent-tabs-mode: nil */
+/* End: */
@@ -0,0 +1,274 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+/* such software.  many freedoms. */
+
+#include <cdson.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* every layout must dump the same as the plain one, however it's fed */
+static const char *docs[] = {
+    "empty",
+    "\"\"",
+    "\"doge\"",
+    "\"seven!!\"",
+    "\"eight!!!\"",
+    "\"c\\nd\\/e\\\"f\\\\\"",
+    "\"\xe3\x82\xa2\xe3\x82\xa2!\"",
+    "\"\xe3\x82\xa2\xe3\x82\xa2\xc3\xa9\"",
+    "1",
+    "so many",
+    "so 7 many",
+    "so 1 and 2 also 3 many",
+    "so 1 and \"x\" many",
+    "so \"x\" and 1 and 2 many",
+    "so 1 and 2 and so 3 many and 4 many",
+    "so so 1 and 2 many and so 3 many many",
+    "so 1 and so many and 2 many",
+    "so \"a\" and yes and no and empty and 1.4very2 many",
+    "so \"a\" and \"bb\" and \"a much longer string\" and 1 many",
+    "such \"shiba\" is \"inu\", \"doge\" is yes wow",
+    "such \"shiba\" is \"inu\", \"a key too long to fit\" is \"x\" wow",
+    "such \"a\" is so such \"b\" is so 1 and 2 many wow and empty many wow",
+    "so so so many many and such \"x\" is such \"y\" is so many wow wow "
+    "many",
+    "such \"k\" is 1, \"k\" is 2! \"k\" is 3? \"j\" is \"c\\nd\" wow",
+    "such \"k\" is so \"t1\" and \"t2\" many! \"k\" is such \"\" is \"\" wow "
+    "wow",
+    "so 1 and so 2 and 3 many and \"x\" and so many many",
+};
+#define N_DOCS (sizeof(docs) / sizeof(*docs))
+
+/* such layouts.  each alone, and all together */
+typedef struct {
+    bool packed;
+    bool compact;
+    bool inline_strings;
+} layout;
+
+static const layout layouts[] = {
+    { true, false, false },
+    { false, true, false },
+    { false, false, true },
+    { true, true, false },
+    { false, true, true },
+    { true, true, true },
+};
+#define N_LAYOUTS (sizeof(layouts) / sizeof(*layouts))
+
+static char *dump(dson_value *v) {
+    char *err, *out;
+    size_t len;
+
+    err = dson_dump(v, &out, &len);
+    if (err != NULL) {
+        fprintf(stderr, "dump failure: %s\n", err);
+        exit(1);
+    }
+    return out;
+}
+
+static dson_value *parse(const char *in, const dson_options *opts) {
+    dson_value *v;
+    char *err;
+
+    err = dson_parse_opts(in, strlen(in), opts, &v);
+    if (err != NULL) {
+        fprintf(stderr, "parse failure: %s\n", err);
+        exit(1);
+    }
+    return v;
+}
+
+static void describe(const layout *l, const dson_arena *a) {
+    printf("%s%s%s%s", l->packed ? " (packed)" : "",
+           l->compact ? " (compact)" : "",
+           l->inline_strings ? " (inline)" : "", a != NULL ? " (arena)" : "");
+}
+
+/* nothing but numbers, and some of them */
+static bool packable(dson_value **vs) {
+    for (size_t i = 0; vs[i] != NULL; i++) {
+        if (vs[i]->type != DSON_DOUBLE)
+            return false;
+    }
+    return vs[0] != NULL;
+}
+
+static bool packable_list(const dson_list *l) {
+    for (size_t i = 0; i < l->len; i++) {
+        if (l->items[i].type != DSON_DOUBLE)
+            return false;
+    }
+    return l->len > 0;
+}
+
+/* the tree is laid out as l says, all the way down */
+static bool laid_out(const dson_value *v, const layout *l) {
+    if (v->type == DSON_DOUBLE_ARRAY) {
+        return l->packed;
+    } else if (v->type == DSON_STRING) {
+        return !l->inline_strings || strlen(v->s) > DSON_INLINE_MAX;
+    } else if (v->type == (DSON_STRING | DSON_INLINE)) {
+        return l->inline_strings && dson_str_len(v) <= DSON_INLINE_MAX &&
+            strlen(dson_str(v)) == dson_str_len(v);
+    } else if (v->type == DSON_ARRAY) {
+        if (l->compact || (l->packed && packable(v->array)))
+            return false;
+        for (size_t i = 0; v->array[i] != NULL; i++) {
+            if (!laid_out(v->array[i], l))
+                return false;
+        }
+    } else if (v->type == DSON_DICT) {
+        if (l->compact)
+            return false;
+        for (size_t i = 0; v->dict->keys[i] != NULL; i++) {
+            if (!laid_out(v->dict->values[i], l))
+                return false;
+        }
+    } else if (v->type == DSON_LIST) {
+        if (!l->compact || (l->packed && packable_list(v->list)))
+            return false;
+        for (size_t i = 0; i < v->list->len; i++) {
+            if (!laid_out(&v->list->items[i], l))
+                return false;
+        }
+    } else if (v->type == DSON_TABLE) {
+        if (!l->compact)
+            return false;
+        for (size_t i = 0; i < v->table->len; i++) {
+            if (!laid_out(&v->table->entries[i].key, l) ||
+                !laid_out(&v->table->entries[i].value, l))
+                return false;
+        }
+    }
+    return true;
+}
+
+static void opts_for(const layout *l, dson_arena *a, dson_options *opts) {
+    memset(opts, 0, sizeof(*opts));
+    opts->packed = l->packed;
+    opts->compact = l->compact;
+    opts->inline_strings = l->inline_strings;
+    opts->arena = a;
+}
+
+static void same(dson_value *v, const char *in) {
+    dson_value *plain;
+    char *out, *plain_out;
+
+    plain = parse(in, NULL);
+    out = dump(v);
+    plain_out = dump(plain);
+    if (strcmp(out, plain_out)) {
+        fprintf(stderr, "mismatch - expected \"%s\", got \"%s\"\n",
+                plain_out, out);
+        exit(1);
+    }
+    free(out);
+    free(plain_out);
+    dson_free(&plain);
+}
+
+/* all at once.  right layout, same dump */
+static void squish(const char *in, const layout *l, dson_arena *a) {
+    dson_options opts;
+    dson_value *v;
+
+    printf("Squishing %s", in);
+    describe(l, a);
+    printf("...");
+    fflush(stdout);
+
+    opts_for(l, a, &opts);
+    v = parse(in, &opts);
+    if (!laid_out(v, l)) {
+        fprintf(stderr, "wrong layout\n");
+        exit(1);
+    }
+    same(v, in);
+    if (a == NULL)
+        dson_free(&v);
+    printf("pass\n");
+}
+
+/* a byte at a time.  same tree */
+static void trickle(const char *in, const layout *l) {
+    dson_options opts;
+    dson_parser *p;
+    dson_value *v;
+    char *err;
+
+    printf("Trickling %s", in);
+    describe(l, NULL);
+    printf("...");
+    fflush(stdout);
+
+    opts_for(l, NULL, &opts);
+    p = dson_parser_new(&opts);
+    for (size_t i = 0; in[i] != '\0'; i++) {
+        err = dson_parser_feed(p, in + i, 1);
+        if (err != NULL) {
+            fprintf(stderr, "feed failure: %s\n", err);
+            exit(1);
+        }
+    }
+    err = dson_parser_finish(&p, &v);
+    if (err != NULL) {
+        fprintf(stderr, "finish failure: %s\n", err);
+        exit(1);
+    } else if (!laid_out(v, l)) {
+        fprintf(stderr, "wrong layout\n");
+        exit(1);
+    }
+    same(v, in);
+    dson_free(&v);
+    printf("pass\n");
+}
+
+/* wherever it stops, nothing leaks */
+static void choke(const char *in, const layout *l) {
+    dson_options opts;
+    dson_value *v;
+    char *err;
+
+    printf("Choking on %s", in);
+    describe(l, NULL);
+    printf("...");
+    fflush(stdout);
+
+    opts_for(l, NULL, &opts);
+    for (size_t len = 0; len < strlen(in); len++) {
+        err = dson_parse_opts(in, len, &opts, &v);
+        if (err == NULL) {
+            /* "so 1 and 2" stops short, but "1" is whole */
+            dson_free(&v);
+            continue;
+        }
+        free(err);
+    }
+    printf("pass\n");
+}
+
+int main() {
+    dson_arena *a;
+
+    a = dson_arena_new();
+    for (size_t i = 0; i < N_LAYOUTS; i++) {
+        for (size_t j = 0; j < N_DOCS; j++) {
+            squish(docs[j], &layouts[i], NULL);
+            squish(docs[j], &layouts[i], a);
+            trickle(docs[j], &layouts[i]);
+            choke(docs[j], &layouts[i]);
+        }
+    }
+    dson_arena_free(&a);
+    return 0;
+}
+
+/* Local variables: */
+/* c-basic-offset: 4 */
+/* indent-tabs-mode: nil */
+/* End: */
@@ -0,0 +1,210 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+/* such software.  many freedoms. */
+
+#include <cdson.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *doc =
+    "such \"config\" is such \"limits\" is such \"cpu\" is 4, \"mem\" is "
+    "10.4very-1, \"disk\" is so 1 also 2 and -3 many wow, \"name\" is "
+    "\"do\\\"ge \\\\ so\" wow, \"list\" is so such \"a\" is 1 wow and such "
+    "\"a\" is 2 wow and 3 many! \"dup\" is yes, \"d\\tp\" is no? "
+    "\"config\" is empty. \"wow\" is so so many and \"many\" many, "
+    "\"\xe3\x82\xb7\" is \"\xe3\x83\x90 such wow\", \"so\" is 7 wow";
+
+static const char *queries[] = {
+    "", ".config", ".config.limits.cpu", ".config.limits.mem",
+    ".config.limits.disk[0]", ".config.limits.disk[1]",
+    ".config.limits.disk[2]", ".config.limits.disk[3]", ".config.name",
+    ".config.name.x", ".config.nope", ".config.nope.deeper", ".list[0].a",
+    ".list[1].a", ".list[2]", ".list[2].a", ".list[3]", ".list.a", ".dup",
+    "[0]", ".list[0]", ".config.limits", ".wow", ".wow[0]", ".wow[0][0]",
+    ".wow[1]", ".many", ".\xe3\x82\xb7", ".so", ".such", ".list[01]",
+    ".config.limits.disk[1][0]",
+};
+#define N_QUERIES (sizeof(queries) / sizeof(*queries))
+
+/* the same text, or else */
+static char *text(dson_value *v) {
+    char *out, *err;
+    size_t len;
+
+    err = dson_dump(v, &out, &len);
+    if (err != NULL) {
+        fprintf(stderr, "dump failure: %s\n", err);
+        exit(1);
+    }
+    return out;
+}
+
+/* lazy or not.  same answers */
+static void agree(dson_value *tree, const char *query, dson_options *opts,
+                  uint8_t match) {
+    dson_value *want = NULL, *got = NULL, *compiled = NULL;
+    dson_query *q;
+    char *err, *lazy, *exec, *a, *b;
+
+    err = dson_fetch(tree, query, match, &want);
+    lazy = dson_fetch_text(doc, strlen(doc), opts, query, match, &got);
+    if (dson_query_compile(query, &q) != NULL)
+        exit(1);
+    exec = dson_query_exec_text(q, doc, strlen(doc), opts, match, &compiled);
+    dson_query_free(&q);
+
+    if ((err == NULL) != (lazy == NULL) || (err == NULL) != (exec == NULL) ||
+        (err != NULL && (strcmp(err, lazy) || strcmp(err, exec)))) {
+        fprintf(stderr, "disagree on %s (%d): %s vs %s vs %s\n", query,
+                match, err == NULL ? "found" : err,
+                lazy == NULL ? "found" : lazy,
+                exec == NULL ? "found" : exec);
+        exit(1);
+    } else if (err != NULL) {
+        free(err);
+        free(lazy);
+        free(exec);
+        return;
+    }
+
+    a = text(want);
+    b = text(got);
+    if (strcmp(a, b)) {
+        fprintf(stderr, "disagree on %s (%d): %s vs %s\n", query, match, a,
+                b);
+        exit(1);
+    }
+    free(b);
+    b = text(compiled);
+    if (strcmp(a, b)) {
+        fprintf(stderr, "disagree on %s (%d), compiled: %s vs %s\n", query,
+                match, a, b);
+        exit(1);
+    }
+    free(a);
+    free(b);
+    if (opts == NULL || opts->arena == NULL) {
+        dson_free(&got);
+        dson_free(&compiled);
+    }
+}
+
+static void run(dson_options *opts, const char *how) {
+    dson_value *tree;
+    char *err;
+
+    printf("Fetching from text (%s)...", how);
+    fflush(stdout);
+
+    err = dson_parse_opts(doc, strlen(doc), opts, &tree);
+    if (err != NULL) {
+        fprintf(stderr, "parse failure: %s\n", err);
+        exit(1);
+    }
+    for (size_t i = 0; i < N_QUERIES; i++) {
+        for (uint8_t match = 0; match <= DSON_MATCH_ERROR; match++)
+            agree(tree, queries[i], opts, match);
+    }
+    if (opts->arena == NULL)
+        dson_free(&tree);
+    printf("pass\n");
+}
+
+/* whatever comes after is never looked at */
+static void reach(const char *in, const char *query, uint8_t match,
+                  dson_options *opts, bool fail) {
+    dson_value *got;
+    char *err;
+
+    printf("Fetching %s from %s (%d)...", query, in, match);
+    fflush(stdout);
+
+    err = dson_fetch_text(in, strlen(in), opts, query, match, &got);
+    if (err == NULL && fail) {
+        fprintf(stderr, "unexpected success\n");
+        exit(1);
+    } else if (err != NULL && !fail) {
+        fprintf(stderr, "fetch failure: %s\n", err);
+        exit(1);
+    } else if (err != NULL) {
+        printf("expected failure: %s\n", err);
+        free(err);
+        return;
+    }
+    dson_free(&got);
+    printf("pass\n");
+}
+
+static void refuse(char *err) {
+    if (err == NULL) {
+        fprintf(stderr, "unexpected success\n");
+        exit(1);
+    }
+    free(err);
+}
+
+int main() {
+    dson_options opts = { 0 };
+    dson_arena *a;
+    dson_value *got;
+
+    run(&opts, "plain");
+    opts.packed = true;
+    opts.integers = true;
+    run(&opts, "packed");
+    opts.compact = true;
+    opts.inline_strings = true;
+    run(&opts, "compact");
+    a = dson_arena_new();
+    opts.arena = a;
+    run(&opts, "arena");
+    dson_arena_free(&a);
+
+    reach("such \"a\" is 1, \"b\" is !!! wow", ".a", DSON_MATCH_FIRST, NULL,
+          false);
+    reach("such \"a\" is 1, \"b\" is !!! wow", ".a", DSON_MATCH_LAST, NULL,
+          true);
+    reach("so 1 and 2 and ~~~", "[1]", DSON_MATCH_FIRST, NULL, false);
+    reach("so 1 and 2 and ~~~", "[2]", DSON_MATCH_FIRST, NULL, true);
+    reach("so \"unterminated and so many", "[1]", DSON_MATCH_FIRST, NULL,
+          true);
+    reach("so so so 1 many many many", "[0][0][0]", DSON_MATCH_FIRST, NULL,
+          false);
+    reach("such \"a\" is so many, \"b\" is 1 wow", ".a[0]",
+          DSON_MATCH_FIRST, NULL, true);
+    reach("such \"a\" is \"\\q\", \"b\" is 1 wow", ".b", DSON_MATCH_FIRST,
+          NULL, false);
+    reach("such \"a\" is 1 wow", ".a", DSON_MATCH_FIRST, NULL, false);
+    reach("such \"a\" is 1", ".a", DSON_MATCH_FIRST, NULL, false);
+    reach("such \"a\" is 1", ".a", DSON_MATCH_ERROR, NULL, true);
+    reach("such \"a\" is x wow", ".a.b", DSON_MATCH_FIRST, NULL, true);
+    reach("", ".a", DSON_MATCH_FIRST, NULL, true);
+    reach("", "", DSON_MATCH_FIRST, NULL, true);
+    reach("so 1 many", "junk", DSON_MATCH_FIRST, NULL, true);
+
+    opts = (dson_options){ 0 };
+    opts.max_depth = 02;
+    reach("so so 1 many many", "[0][0]", DSON_MATCH_FIRST, &opts, false);
+    reach("so so so 1 many many many", "[0]", DSON_MATCH_FIRST, &opts,
+          true);
+    reach("so 1 and so so 1 many many many", "[0]", DSON_MATCH_FIRST, &opts,
+          false);
+    reach("so so so 1 many many and 2 many", "[1]", DSON_MATCH_FIRST, &opts,
+          true);
+
+    printf("Fetching from text with bad arguments...");
+    refuse(dson_fetch_text(doc, strlen(doc), NULL, NULL, 0, &got));
+    refuse(dson_fetch_text(doc, strlen(doc), NULL, "", 0, NULL));
+    refuse(dson_fetch_text(doc, strlen(doc), NULL, "",
+                           DSON_MATCH_ERROR + 1, &got));
+    refuse(dson_query_exec_text(NULL, doc, strlen(doc), NULL, 0, &got));
+    printf("expected failure\n");
+    return 0;
+}
+
+/* Local variables: */
+/* c-basic-offset: 4 */
+/* indent-tabs-mode: nil */
+/* End: */
@@ -0,0 +1,194 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+/* such software.  many freedoms. */
+
+#include <cdson.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *docs[] = {
+    "empty",
+    "\"doge\"",
+    "so many",
+    "so 1 and 2 also 3 many",
+    "so \"a\" and yes and so many and such \"b\" is 1 wow many",
+    "such \"shiba\" is \"inu\", \"doge\" is yes, \"doge\" is no wow",
+    "such \"a\" is so such \"b\" is so 1 and 2 many wow and empty many wow",
+};
+#define N_DOCS (sizeof(docs) / sizeof(*docs))
+
+static dson_value *parse(const char *in, dson_options *opts) {
+    dson_value *v;
+    char *err;
+
+    err = dson_parse_opts(in, strlen(in), opts, &v);
+    if (err != NULL) {
+        fprintf(stderr, "parse failure: %s\n", err);
+        exit(1);
+    }
+    return v;
+}
+
+/* much count.  the slow way */
+static void check(dson_value *v) {
+    size_t n = 0, want_array = 0, want_dict = 0;
+
+    if (v->type == DSON_ARRAY) {
+        while (v->array[n] != NULL)
+            check(v->array[n++]);
+        want_array = n;
+    } else if (v->type == DSON_LIST) {
+        for (; n < v->list->len; n++)
+            check(&v->list->items[n]);
+        want_array = n;
+    } else if (v->type == DSON_DOUBLE_ARRAY) {
+        want_array = v->doubles->len;
+    } else if (v->type == DSON_DICT) {
+        while (v->dict->keys[n] != NULL)
+            check(v->dict->values[n++]);
+        want_dict = n;
+    } else if (v->type == DSON_TABLE) {
+        for (; n < v->table->len; n++)
+            check(&v->table->entries[n].value);
+        want_dict = n;
+    }
+
+    if (dson_array_len(v) != want_array || dson_dict_len(v) != want_dict) {
+        fprintf(stderr, "type %d: expected %zu and %zu, got %zu and %zu\n",
+                v->type, want_array, want_dict, dson_array_len(v),
+                dson_dict_len(v));
+        exit(1);
+    }
+}
+
+static void count(const char *in, dson_options *opts, const char *how) {
+    dson_value *v;
+
+    printf("Counting %s (%s)...", in, how);
+    fflush(stdout);
+
+    v = parse(in, opts);
+    check(v);
+    dson_free(&v);
+    printf("pass\n");
+}
+
+static void reach(dson_value *v, const char *query, bool fail) {
+    dson_value *got;
+    char *err;
+
+    printf("Fetching %s...", query);
+    fflush(stdout);
+
+    err = dson_fetch(v, query, DSON_MATCH_FIRST, &got);
+    if (err == NULL && fail) {
+        fprintf(stderr, "unexpected success\n");
+        exit(1);
+    } else if (err != NULL && !fail) {
+        fprintf(stderr, "fetch failure: %s\n", err);
+        exit(1);
+    } else if (err != NULL) {
+        printf("expected failure: %s\n", err);
+        free(err);
+        return;
+    }
+    printf("pass\n");
+}
+
+/* no parser.  padding is whatever the stack had.  still works */
+static void by_hand(void) {
+    dson_value one, two, array, dict;
+    dson_value *items[] = { &one, &two, NULL };
+    char *keys[] = { "a", "b", NULL };
+    dson_dict d = { keys, items };
+
+    one.type = DSON_DOUBLE;
+    two.type = DSON_BOOL;
+    array.type = DSON_ARRAY;
+    array.array = items;
+    dict.type = DSON_DICT;
+    dict.dict = &d;
+
+    printf("Counting by hand...");
+    fflush(stdout);
+    check(&array);
+    check(&dict);
+    printf("pass\n");
+
+    reach(&array, "[1]", false);
+    reach(&array, "[2]", true);
+    reach(&dict, ".b", false);
+}
+
+/* such edit.  the NULL moved, and so did the end */
+static void shorten(void) {
+    dson_value *v;
+
+    v = parse("so 1 and 2 and 3 many", NULL);
+    printf("Truncating...");
+    fflush(stdout);
+    dson_free(&v->array[2]);
+    dson_free(&v->array[1]);
+    if (dson_array_len(v) != 1) {
+        fprintf(stderr, "expected 1, got %zu\n", dson_array_len(v));
+        exit(1);
+    }
+    printf("pass\n");
+
+    reach(v, "[0]", false);
+    reach(v, "[1]", true);
+    reach(v, "[2]", true);
+    dson_free(&v);
+}
+
+/* such long.  the end is as close as the start */
+static void stretch(void) {
+    dson_value *v;
+    char *big, query[0100];
+    size_t len = 0, n = 0200000;
+
+    big = malloc(n * 020 + 16);
+    if (big == NULL)
+        exit(1);
+    len += sprintf(big, "so ");
+    for (size_t i = 0; i < n; i++)
+        len += sprintf(big + len, "yes %s ", i + 1 < n ? "and" : "many");
+
+    v = parse(big, NULL);
+    free(big);
+    if (dson_array_len(v) != n) {
+        fprintf(stderr, "expected %zu, got %zu\n", n, dson_array_len(v));
+        exit(1);
+    }
+    sprintf(query, "[%zu]", n - 1);
+    reach(v, query, false);
+    sprintf(query, "[%zu]", n);
+    reach(v, query, true);
+    dson_free(&v);
+}
+
+int main() {
+    dson_options opts = { 0 };
+
+    for (size_t i = 0; i < N_DOCS; i++) {
+        count(docs[i], NULL, "plain");
+        opts.packed = true;
+        count(docs[i], &opts, "packed");
+        opts.compact = true;
+        count(docs[i], &opts, "compact");
+        opts.packed = false;
+        opts.compact = false;
+    }
+
+    by_hand();
+    shorten();
+    stretch();
+    return 0;
+}
+
+/* Local variables: */
+/* c-basic-offset: 4 */
+/* indent-tabs-mode: nil */
+/* End: */
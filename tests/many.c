@@ -0,0 +1,143 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+/* such software.  many freedoms. */
+
+#include <cdson.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *doc =
+    "such \"config\" is such \"limits\" is such \"cpu\" is 4, \"mem\" is "
+    "10, \"disk\" is so 1 and 2 many wow, \"name\" is \"doge\" wow, "
+    "\"list\" is so such \"a\" is 1 wow and such \"a\" is 2 wow and 3 many! "
+    "\"dup\" is 1, \"dup\" is 2, \"config\" is empty wow";
+
+static const char *queries[] = {
+    "", ".config", ".config.limits.cpu", ".config.limits.mem",
+    ".config.limits.disk[0]", ".config.limits.disk[1]",
+    ".config.limits.disk[2]", ".config.limits.cpu", ".config.name",
+    ".config.name.x", ".config.nope", ".config.nope.deeper", ".list[0].a",
+    ".list[1].a", ".list[2]", ".list[2].a", ".list.a", ".dup", "[0]",
+    ".list[0]", "junk", ".list[x]", ".config[", ".config.limits",
+    ".config.limits.", NULL,
+};
+#define N_QUERIES (sizeof(queries) / sizeof(*queries))
+
+/* all at once, or one at a time.  same answers */
+static void agree(dson_value *tree, uint8_t match, const char *how) {
+    dson_value *outs[N_QUERIES], *want;
+    char *errs[N_QUERIES], *err;
+
+    printf("Fetching many (%s, %d)...", how, match);
+    fflush(stdout);
+
+    err = dson_fetch_many(tree, queries, N_QUERIES, match, outs, errs);
+    if (err != NULL) {
+        fprintf(stderr, "fetch_many failure: %s\n", err);
+        exit(1);
+    }
+
+    for (size_t i = 0; i < N_QUERIES; i++) {
+        want = NULL;
+        err = dson_fetch(tree, queries[i], match, &want);
+        if ((err == NULL) != (errs[i] == NULL) ||
+            (err != NULL && strcmp(err, errs[i])) ||
+            (err == NULL && outs[i] != want) ||
+            (err != NULL && outs[i] != NULL)) {
+            fprintf(stderr, "disagree on %s: %s vs %s\n", queries[i],
+                    err == NULL ? "found" : err,
+                    errs[i] == NULL ? "found" : errs[i]);
+            exit(1);
+        }
+        free(err);
+        free(errs[i]);
+    }
+
+    /* no errs.  outs alone tell */
+    err = dson_fetch_many(tree, queries, N_QUERIES, match, outs, NULL);
+    if (err != NULL) {
+        fprintf(stderr, "fetch_many failure: %s\n", err);
+        exit(1);
+    }
+    for (size_t i = 0; i < N_QUERIES; i++) {
+        want = NULL;
+        err = dson_fetch(tree, queries[i], match, &want);
+        if (outs[i] != (err == NULL ? want : NULL)) {
+            fprintf(stderr, "disagree on %s without errs\n", queries[i]);
+            exit(1);
+        }
+        free(err);
+    }
+    printf("pass\n");
+}
+
+static void run(dson_options *opts, const char *how) {
+    dson_value *tree;
+    char *err;
+
+    err = dson_parse_opts(doc, strlen(doc), opts, &tree);
+    if (err != NULL) {
+        fprintf(stderr, "parse failure: %s\n", err);
+        exit(1);
+    }
+    for (uint8_t match = 0; match <= DSON_MATCH_ERROR; match++)
+        agree(tree, match, how);
+    dson_free(&tree);
+}
+
+static void refuse(dson_value *tree, const char *const *qs, size_t n,
+                   uint8_t match, dson_value **outs, const char *what) {
+    char *err;
+
+    printf("Fetching many with %s...", what);
+    fflush(stdout);
+
+    err = dson_fetch_many(tree, qs, n, match, outs, NULL);
+    if (err == NULL) {
+        fprintf(stderr, "unexpected success\n");
+        exit(1);
+    }
+    printf("expected failure: %s\n", err);
+    free(err);
+}
+
+int main() {
+    dson_options opts = { 0 };
+    dson_value *tree, *outs[N_QUERIES];
+    char *err;
+
+    run(&opts, "plain");
+    opts.packed = true;
+    run(&opts, "packed");
+    opts.compact = true;
+    opts.inline_strings = true;
+    run(&opts, "compact");
+
+    err = dson_parse(doc, strlen(doc), false, &tree);
+    if (err != NULL) {
+        fprintf(stderr, "parse failure: %s\n", err);
+        exit(1);
+    }
+    refuse(NULL, queries, N_QUERIES, 0, outs, "no tree");
+    refuse(tree, NULL, N_QUERIES, 0, outs, "no queries");
+    refuse(tree, queries, N_QUERIES, 0, NULL, "no outs");
+    refuse(tree, queries, N_QUERIES, DSON_MATCH_ERROR + 1, outs,
+           "a bad match behavior");
+
+    printf("Fetching none...");
+    err = dson_fetch_many(tree, NULL, 0, 0, NULL, NULL);
+    if (err != NULL) {
+        fprintf(stderr, "failure: %s\n", err);
+        exit(1);
+    }
+    printf("pass\n");
+    dson_free(&tree);
+    return 0;
+}
+
+/* Local variables: */
+/* c-basic-offset: 4 */
+/* indent-tabs-mode: nil */
+/* End: */
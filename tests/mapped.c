@@ -0,0 +1,190 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+/* such software.  many freedoms. */
+
+#include <cdson.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static char *dump(dson_value *v) {
+    char *out, *err;
+    size_t len;
+
+    err = dson_dump(v, &out, &len);
+    if (err != NULL) {
+        fprintf(stderr, "dump failure: %s\n", err);
+        exit(1);
+    }
+    return out;
+}
+
+static void check(char *err, dson_value *v, const char *expected) {
+    char *out;
+
+    if (expected == NULL) {
+        if (err == NULL || v != NULL) {
+            fprintf(stderr, "unexpected success\n");
+            exit(1);
+        }
+        printf("expected failure: %s\n", err);
+        free(err);
+        return;
+    } else if (err != NULL) {
+        fprintf(stderr, "parse failure: %s\n", err);
+        exit(1);
+    }
+
+    out = dump(v);
+    if (strcmp(out, expected)) {
+        fprintf(stderr, "mismatch - expected \"%s\", got \"%s\"\n",
+                expected, out);
+        exit(1);
+    }
+    free(out);
+    dson_free(&v);
+    printf("pass\n");
+}
+
+/* exact-size bowl.  nothing after.  no '\0' to lean on */
+static void tight(const char *in, const char *expected) {
+    size_t len = strlen(in);
+    dson_value *v;
+    char *buf, *err;
+
+    printf("Testing unterminated %s...", in);
+    fflush(stdout);
+
+    buf = malloc(len);
+    if (buf == NULL)
+        exit(1);
+    memcpy(buf, in, len);
+    err = dson_parse(buf, len, false, &v);
+    check(err, v, expected);
+    free(buf);
+}
+
+static void mapped(const char *in, const char *expected) {
+    char path[] = "/tmp/cdson-mapped-XXXXXX";
+    dson_value *v;
+    char *err;
+    int fd;
+
+    printf("Testing file containing %s...", in);
+    fflush(stdout);
+
+    fd = mkstemp(path);
+    if (fd == -1 || write(fd, in, strlen(in)) != (ssize_t)strlen(in))
+        exit(1);
+    close(fd);
+
+    err = dson_parse_file(path, NULL, &v);
+    check(err, v, expected);
+    unlink(path);
+}
+
+/* no size.  no map.  much pipe */
+static void piped(const char *in, const char *expected) {
+    char path[040];
+    dson_value *v;
+    char *err;
+    size_t len = strlen(in), off = 0;
+    ssize_t n;
+    int fds[2];
+    pid_t pid;
+
+    printf("Testing pipe carrying %.40s...", in);
+    fflush(stdout);
+
+    if (pipe(fds) == -1)
+        exit(1);
+    pid = fork();
+    if (pid == -1) {
+        exit(1);
+    } else if (pid == 0) {
+        close(fds[0]);
+        for (; off < len; off += n) {
+            n = write(fds[1], in + off, len - off);
+            if (n <= 0)
+                _exit(1);
+        }
+        _exit(0);
+    }
+    close(fds[1]);
+
+    sprintf(path, "/dev/fd/%d", fds[0]);
+    err = dson_parse_file(path, NULL, &v);
+    close(fds[0]);
+    waitpid(pid, NULL, 0);
+    check(err, v, expected);
+}
+
+/* more than one read's worth */
+static void big_pipe(void) {
+    dson_value *v;
+    char *in, *expected;
+    size_t len = 0, n = 0100000;
+
+    in = malloc(n * 010 + 16);
+    if (in == NULL)
+        exit(1);
+    len += sprintf(in, "so ");
+    for (size_t i = 0; i < n; i++)
+        len += sprintf(in + len, "%zo %s ", i % 010, i + 1 < n ? "and" :
+                       "many");
+    if (dson_parse(in, len, false, &v) != NULL)
+        exit(1);
+    expected = dump(v);
+    dson_free(&v);
+
+    piped(in, expected);
+    free(expected);
+    free(in);
+}
+
+int main() {
+    dson_value *v;
+    char *err;
+
+    tight("empty", "empty");
+    tight("yes", "yes");
+    tight("ye", NULL);
+    tight("5", "5");
+    tight("-1.4very3", "-1400");
+    tight("1.", NULL);
+    tight("1very", NULL);
+    tight("so 1 and 2 many", "so 1 and 2 many");
+    tight("so 1 and 2 man", NULL);
+    tight("such \"a\" is \"b\" wow", "such \"a\" is \"b\" wow");
+    tight("such \"a\" is \"b\" wo", NULL);
+    tight("\"abc", NULL);
+    tight("\"ab\\", NULL);
+    tight("\"\xe3\x82", NULL);
+
+    mapped("such \"doge\" is so \"very\" and \"wow\" many wow",
+           "such \"doge\" is so \"very\" and \"wow\" many wow");
+    mapped("empty", "empty");
+    mapped("", NULL);
+    mapped("so 1 and", NULL);
+
+    piped("such \"doge\" is so \"very\" and \"wow\" many wow",
+          "such \"doge\" is so \"very\" and \"wow\" many wow");
+    piped("empty", "empty");
+    piped("", NULL);
+    piped("so 1 and", NULL);
+    big_pipe();
+
+    printf("Testing missing file...");
+    err = dson_parse_file("/nonexistent/doge.dson", NULL, &v);
+    check(err, v, NULL);
+
+    return 0;
+}
+
+/* Local variables: */
+/* c-basic-offset: 4 */
+/* indent-tabs-mode: nil */
+/* End: */
@@ -0,0 +1,132 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+/* such software.  many freedoms. */
+
+#include <cdson.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* exact.  no epsilon.  wow */
+static void count(const char *in, double expected) {
+    dson_value *v;
+    char *err;
+
+    printf("Counting %.60s...", in);
+    fflush(stdout);
+
+    err = dson_parse(in, strlen(in), false, &v);
+    if (err != NULL) {
+        fprintf(stderr, "parse failure: %s\n", err);
+        exit(1);
+    } else if (v->type != DSON_DOUBLE) {
+        fprintf(stderr, "not a number\n");
+        exit(1);
+    } else if (v->n != expected || signbit(v->n) != signbit(expected)) {
+        fprintf(stderr, "mismatch - expected %a, got %a\n", expected, v->n);
+        exit(1);
+    }
+    dson_free(&v);
+    printf("pass\n");
+}
+
+/* xorshift.  same kibble every run */
+static unsigned long long seed = 88172645463325252ULL;
+static unsigned long long noise(void) {
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    return seed;
+}
+
+/* dump, parse, same bits.  very round.  such trip */
+static void trip(size_t n) {
+    unsigned long long bits;
+    dson_value v = { 0 }, *back;
+    char *out, *err;
+    size_t len;
+
+    printf("Round-tripping %zu doubles...", n);
+    fflush(stdout);
+
+    v.type = DSON_DOUBLE;
+    for (size_t i = 0; i < n; i++) {
+        do {
+            bits = noise();
+            memcpy(&v.n, &bits, sizeof(v.n));
+        } while (!isfinite(v.n));
+        if (i % 2)
+            v.n = (double)(long long)(v.n / 1e290); /* whole dogs too */
+
+        err = dson_dump(&v, &out, &len);
+        if (err != NULL) {
+            fprintf(stderr, "dump failure: %s\n", err);
+            exit(1);
+        } else if (len > 30) {
+            fprintf(stderr, "too long: %s\n", out);
+            exit(1);
+        }
+
+        err = dson_parse(out, len, false, &back);
+        if (err != NULL) {
+            fprintf(stderr, "parse failure on %s: %s\n", out, err);
+            exit(1);
+        } else if (back->n != v.n) {
+            fprintf(stderr, "%a became %s became %a\n", v.n, out, back->n);
+            exit(1);
+        }
+        dson_free(&back);
+        free(out);
+    }
+    printf("pass\n");
+}
+
+int main() {
+    count("0", 0);
+    count("-0", -0.0);
+    count("17", 15);
+    count("-  17", -15);
+    count("0.1", 0.125);
+    count("1.44", 1.5625);
+    count("0.0001", ldexp(1, -12));
+    count("1 .4 very 2", 96);
+    count("1.4very-2", 1.5 / 64);
+    count("3VERY+3", 1536);
+    count("1very-0", 1);
+
+    /* 2**53 and friends.  ties go to even */
+    count("400000000000000000", ldexp(1, 53));
+    count("400000000000000001", ldexp(1, 53));
+    count("400000000000000003", ldexp(1, 53) + 4);
+    count("400000000000000001.0001", ldexp(1, 53) + 2);
+
+    /* more digits than fit in 64 bits */
+    count("7777777777777777777777", ldexp(1, 66));
+    count("1000000000000000000000000000000000001", ldexp(1, 108));
+    count("4000000000000000000100000000000000000000001.0", ldexp(1, 128));
+    count("0.77777777777777777777777777777777777777", 1);
+    count("0.12345670123456701234567", 0x1.4e5dc14e5dc15p-3);
+
+    /* such range */
+    count("1very400", ldexp(1, 768));
+    count("1very-400", ldexp(1, -768));
+    count("1very7777777", HUGE_VAL);
+    count("1very-7777777", 0);
+    count("1very-546", ldexp(1, -1074));
+    count("3very-546", ldexp(3, -1074));
+    count("1.4very-546", ldexp(2, -1074));
+    count("0.4very-546", 0);
+    count("0.40000000000000000000001very-546", ldexp(1, -1074));
+    count("1.4very-547", 0);
+
+    trip(100000);
+
+    return 0;
+}
+
+/* Local variables: */
+/* c-basic-offset: 4 */
+/* indent-tabs-mode: nil */
+/* End: */
@@ -0,0 +1,215 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+/* such software.  many freedoms. */
+
+#include <cdson.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* much outline.  "p3" is three numbers, packed */
+static size_t shape(dson_value *v, char *out) {
+    size_t len = 0;
+
+    if (v->type == DSON_DOUBLE_ARRAY)
+        return sprintf(out, "p%zu", v->doubles->len);
+    else if (v->type == DSON_DOUBLE)
+        return sprintf(out, "n");
+    else if (v->type == DSON_INT)
+        return sprintf(out, "i");
+    else if (v->type == DSON_STRING)
+        return sprintf(out, "s");
+    else if (v->type == DSON_DICT)
+        return sprintf(out, "{%s}", v->dict->keys[0] == NULL ? "" : "...");
+    else if (v->type != DSON_ARRAY)
+        return sprintf(out, "?");
+
+    out[len++] = '[';
+    for (size_t i = 0; v->array[i] != NULL; i++) {
+        if (i > 0)
+            out[len++] = ',';
+        len += shape(v->array[i], out + len);
+    }
+    out[len++] = ']';
+    out[len] = '\0';
+    return len;
+}
+
+/* packed where it can be.  dumping is tests/layouts.c's job */
+static void pack(const char *in, bool integers, const char *expected) {
+    dson_options opts = { 0 };
+    dson_value *v;
+    char *err, got[0200];
+
+    printf("Packing %s...", in);
+    fflush(stdout);
+
+    opts.packed = true;
+    opts.integers = integers;
+    err = dson_parse_opts(in, strlen(in), &opts, &v);
+    if (err != NULL) {
+        fprintf(stderr, "parse failure: %s\n", err);
+        exit(1);
+    }
+    shape(v, got);
+    if (strcmp(got, expected)) {
+        fprintf(stderr, "mismatch - expected %s, got %s\n", expected, got);
+        exit(1);
+    }
+
+    dson_free(&v);
+    printf("pass\n");
+}
+
+/* reach inside */
+static void fetch(dson_value *v, const char *query, double expected) {
+    dson_value *got, *again;
+    char *err;
+
+    printf("Fetching %s...", query);
+    fflush(stdout);
+
+    err = dson_fetch(v, query, DSON_MATCH_FIRST, &got);
+    if (err != NULL) {
+        fprintf(stderr, "fetch failure: %s\n", err);
+        exit(1);
+    } else if (got->type != DSON_DOUBLE || got->n != expected) {
+        fprintf(stderr, "expected %g\n", expected);
+        exit(1);
+    }
+
+    err = dson_fetch(v, query, DSON_MATCH_FIRST, &again);
+    if (err != NULL || again != got) {
+        fprintf(stderr, "second fetch moved\n");
+        exit(1);
+    }
+    printf("pass\n");
+}
+
+static void miss(dson_value *v, const char *query) {
+    dson_value *got;
+    char *err;
+
+    printf("Fetching %s...", query);
+    fflush(stdout);
+
+    err = dson_fetch(v, query, DSON_MATCH_FIRST, &got);
+    if (err == NULL) {
+        fprintf(stderr, "unexpected success\n");
+        exit(1);
+    }
+    printf("expected failure: %s\n", err);
+    free(err);
+}
+
+/* much metrics.  one bowl */
+static void stretch(dson_arena *a) {
+    dson_options opts = { 0 };
+    dson_value *v;
+    char *big, *err;
+    size_t len = 0, n = 0200001;
+
+    printf("Packing %zu numbers...", n);
+    fflush(stdout);
+
+    big = malloc(n * 020 + 16);
+    if (big == NULL)
+        exit(1);
+    len += sprintf(big, "so ");
+    for (size_t i = 0; i < n; i++)
+        len += sprintf(big + len, "%zo %s ", i, i + 1 < n ? "and" : "many");
+
+    opts.packed = true;
+    opts.arena = a;
+    err = dson_parse_opts(big, len, &opts, &v);
+    if (err != NULL) {
+        fprintf(stderr, "parse failure: %s\n", err);
+        exit(1);
+    } else if (v->type != DSON_DOUBLE_ARRAY || v->doubles->len != n) {
+        fprintf(stderr, "not packed\n");
+        exit(1);
+    }
+    for (size_t i = 0; i < n; i++) {
+        if (v->doubles->n[i] != i) {
+            fprintf(stderr, "element %zu is %g\n", i, v->doubles->n[i]);
+            exit(1);
+        }
+    }
+    free(big);
+    printf("pass\n");
+
+    fetch(v, "[65535]", 65535);
+    fetch(v, "[65536]", 65536);
+    fetch(v, "[0]", 0);
+    fetch(v, "[64]", 64);
+
+    /* only the runs asked about got boxed */
+    printf("Counting boxes...");
+    for (size_t i = 0; i < (n + 63) / 64; i++) {
+        if ((v->doubles->boxes[i] != NULL) !=
+            (i == 0 || i == 1 || i == 1023 || i == 1024)) {
+            fprintf(stderr, "run %zu boxed wrong\n", i);
+            exit(1);
+        }
+    }
+    printf("pass\n");
+    if (a == NULL)
+        dson_free(&v);
+}
+
+int main() {
+    const char *in = "such \"m\" is so 1 and 2.4 and 3very1 many, \"e\" is "
+        "so many wow";
+    dson_options opts = { 0 };
+    dson_arena *a;
+    dson_value *v;
+    char *err;
+
+    pack("so 1 and 2 also 3 many", false, "p3");
+    pack("so 7 many", false, "p1");
+    pack("so many", false, "[]");
+    pack("so 1 and \"x\" many", false, "[n,s]");
+    pack("so \"x\" and 1 and 2 many", false, "[s,n,n]");
+    pack("so 1 and 2 and so 3 many and 4 many", false, "[n,n,p1,n]");
+    pack("so so 1 and 2 many and so 3 many many", false, "[p2,p1]");
+    pack("so 1 and 2 and such \"a\" is 3 wow many", false, "[n,n,{...}]");
+    pack("so 1 and so many and 2 many", false, "[n,[],n]");
+    pack("so 1 and 2.4 many", true, "[i,n]");
+    pack("so 1.4 and 2very1 many", true, "p2");
+    pack("1", false, "n");
+
+    opts.packed = true;
+    err = dson_parse_opts(in, strlen(in), &opts, &v);
+    if (err != NULL) {
+        fprintf(stderr, "parse failure: %s\n", err);
+        exit(1);
+    }
+    fetch(v, ".m[0]", 1);
+    fetch(v, ".m[2]", 030);
+    fetch(v, ".m[1]", 2.5);
+    miss(v, ".m[3]");
+    miss(v, ".m[1].x");
+    miss(v, ".m.x");
+    dson_free(&v);
+
+    printf("Failing halfway...");
+    err = dson_parse_opts("so 1 and 2 and so 3 and", 23, &opts, &v);
+    if (err == NULL) {
+        fprintf(stderr, "unexpected success\n");
+        exit(1);
+    }
+    printf("expected failure: %s\n", err);
+    free(err);
+
+    stretch(NULL);
+    a = dson_arena_new();
+    stretch(a);
+    dson_arena_free(&a);
+    return 0;
+}
+
+/* Local variables: */
+/* c-basic-offset: 4 */
+/* indent-tabs-mode: nil */
+/* End: */
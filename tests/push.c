@@ -0,0 +1,233 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+/* such software.  many freedoms. */
+
+#include <cdson.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static char *dump(dson_value *v) {
+    char *out, *err;
+    size_t len;
+
+    err = dson_dump(v, &out, &len);
+    if (err != NULL) {
+        fprintf(stderr, "dump failure: %s\n", err);
+        exit(1);
+    }
+    return out;
+}
+
+/* feed in chunks of `step`, starting with a chunk of `first` */
+static char *dribble(const char *in, size_t first, size_t step,
+                     dson_value **out) {
+    dson_parser *p;
+    size_t len = strlen(in), off = 0, n;
+    char chunk[64];
+    char *err;
+
+    p = dson_parser_new(NULL);
+    for (n = first; off < len; off += n, n = step) {
+        if (n > len - off)
+            n = len - off;
+
+        /* own copy, scribbled after.  no peeking at old chunks */
+        memcpy(chunk, in + off, n);
+        err = dson_parser_feed(p, chunk, n);
+        memset(chunk, '?', sizeof(chunk));
+
+        /* nothing at all.  changes nothing */
+        if (err == NULL)
+            err = dson_parser_feed(p, NULL, 0);
+        if (err != NULL) {
+            free(dson_parser_finish(&p, out));
+            return err;
+        }
+    }
+    return dson_parser_finish(&p, out);
+}
+
+/* every split.  same tree as all at once */
+static void trickle(const char *in) {
+    dson_value *v;
+    char *err, *out, *expected;
+    size_t len = strlen(in);
+
+    printf("Trickling %s...", in);
+    fflush(stdout);
+
+    err = dson_parse(in, len, false, &v);
+    if (err != NULL) {
+        fprintf(stderr, "parse failure: %s\n", err);
+        exit(1);
+    }
+    expected = dump(v);
+    dson_free(&v);
+
+    for (size_t first = 0; first <= len; first++) {
+        for (size_t step = 1; step <= 7; step++) {
+            err = dribble(in, first, step, &v);
+            if (err != NULL) {
+                fprintf(stderr, "parse failure (%zu, %zu): %s\n", first,
+                        step, err);
+                exit(1);
+            }
+
+            out = dump(v);
+            if (strcmp(out, expected)) {
+                fprintf(stderr, "mismatch (%zu, %zu) - expected \"%s\", "
+                        "got \"%s\"\n", first, step, expected, out);
+                exit(1);
+            }
+            free(out);
+            dson_free(&v);
+        }
+    }
+    free(expected);
+    printf("pass\n");
+}
+
+/* same complaint, same place, however it arrives */
+static void choke(const char *in) {
+    dson_value *v;
+    char *whole, *err;
+
+    printf("Choking on %s...", in);
+    fflush(stdout);
+
+    whole = dson_parse(in, strlen(in), false, &v);
+    if (whole == NULL) {
+        fprintf(stderr, "unexpected success\n");
+        exit(1);
+    }
+
+    for (size_t step = 1; step <= strlen(in); step++) {
+        err = dribble(in, step, step, &v);
+        if (err == NULL || v != NULL) {
+            fprintf(stderr, "unexpected success (%zu)\n", step);
+            exit(1);
+        } else if (strcmp(err, whole)) {
+            fprintf(stderr, "mismatch (%zu) - expected \"%s\", got \"%s\"\n",
+                    step, whole, err);
+            exit(1);
+        }
+        free(err);
+    }
+    printf("expected failure: %s\n", whole);
+    free(whole);
+}
+
+/* one long string.  many chunks.  each byte looked at once, not once per
+ * feed */
+static void stretch(size_t n) {
+    dson_value *v;
+    char *in, *err, *out, *expected;
+    size_t len;
+
+    printf("Trickling a %zu byte string...", n);
+    fflush(stdout);
+
+    in = malloc(n * 2 + 040);
+    if (in == NULL)
+        exit(1);
+    len = sprintf(in, "so  \"");
+    for (size_t i = 0; i < n; i++) {
+        if (i % 0101 == 0100)
+            in[len++] = '\\'; /* such quote.  not the end */
+        in[len++] = i % 0101 == 0100 ? '"' : 'a' + i % 032;
+    }
+    len += sprintf(in + len, "\"  many");
+
+    err = dson_parse(in, len, false, &v);
+    if (err != NULL) {
+        fprintf(stderr, "parse failure: %s\n", err);
+        exit(1);
+    }
+    expected = dump(v);
+    dson_free(&v);
+
+    err = dribble(in, 1, 64, &v);
+    if (err != NULL) {
+        fprintf(stderr, "failure: %s\n", err);
+        exit(1);
+    }
+    out = dump(v);
+    if (strcmp(out, expected)) {
+        fprintf(stderr, "mismatch\n");
+        exit(1);
+    }
+    free(out);
+    free(expected);
+    dson_free(&v);
+    free(in);
+    printf("pass\n");
+}
+
+int main() {
+    dson_parser *p;
+    dson_value *v;
+    char *err;
+
+    trickle("empty");
+    trickle("yes");
+    trickle("-5.4very-2");
+    trickle("7");
+    trickle("so many");
+    trickle("so 1 and 2 also 3 many");
+    trickle("so  so  many  many");
+    trickle("such \"foo\" is such \"shiba\" is \"inu\", \"doge\" is no wow "
+            "wow");
+    trickle("\"a\\\"b\\\\c\\/d\\ne\"");
+    trickle("so \"\xe3\x82\xb7\xe3\x83\x90\" and \"\xf0\x9f\x90\x95\" many");
+    trickle("such  \"k\\\\\"  is \"\\\"\\\"\"  ,  \"\\\\\\\"\" is so  \"\"  "
+            "many  wow");
+
+    choke("so 1 and 2 also");
+    choke("such \"foo\" is yes, \"bar\" was no wow");
+    choke("so 1 and 2 annd 3 many");
+    choke("\"unterminated");
+    choke("so 8 many");
+    choke("so \"a\\qb\" many");
+    choke("such \"a\" is \"b\\");
+    choke("so \"a\" and \"b\xff\" many");
+
+    stretch(04000000);
+
+    printf("Testing trailing input...");
+    p = dson_parser_new(NULL);
+    err = dson_parser_feed(p, "so many ", 8);
+    if (err == NULL)
+        err = dson_parser_feed(p, "much ignored", 12);
+    if (err == NULL)
+        err = dson_parser_finish(&p, &v);
+    if (err != NULL || v == NULL || v->type != DSON_ARRAY || p != NULL) {
+        fprintf(stderr, "failure: %s\n", err);
+        exit(1);
+    }
+    dson_free(&v);
+    printf("pass\n");
+
+    printf("Testing abandoned parser...");
+    p = dson_parser_new(NULL);
+    err = dson_parser_feed(p, "such \"a\" is so \"b\" and ", 23);
+    if (err != NULL) {
+        fprintf(stderr, "failure: %s\n", err);
+        exit(1);
+    }
+    err = dson_parser_finish(&p, &v);
+    if (err == NULL || v != NULL) {
+        fprintf(stderr, "unexpected success\n");
+        exit(1);
+    }
+    free(err);
+    printf("pass\n");
+
+    return 0;
+}
+
+/* Local variables: */
+/* c-basic-offset: 4 */
+/* indent-tabs-mode: nil */
+/* End: */
@@ -0,0 +1,139 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+/* such software.  many freedoms. */
+
+#include <cdson.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *doc =
+    "such \"a\" is so 1 and so 2 and 3 many and \"x\" many, "
+    "\"b\" is such \"c\" is yes, \"c\" is no, \"\" is empty wow! "
+    "\"a\" is 4? \"long enough to stay a pointer\" is so such \"d\" is "
+    "\"e\" wow many wow";
+
+static const char *queries[] = {
+    "", ".a", ".a[0]", ".a[1]", ".a[1][1]", ".a[2]", ".a[3]", ".a[9]",
+    ".a[0].x", ".b", ".b.c", ".b.", ".b.c.d", ".a.b", ".z", "[0]", ".",
+    ".long enough to stay a pointer[0].d", ".long enough to stay a pointer",
+    ".a[01]", ".a[1][2]", ".a[1][0][0]",
+};
+#define N_QUERIES (sizeof(queries) / sizeof(*queries))
+
+/* compiled or not, same answer */
+static void agree(dson_value *tree, const char *query, uint8_t match) {
+    dson_value *want = NULL, *got = NULL;
+    dson_query *q;
+    const char *failure;
+    char *err;
+
+    err = dson_query_compile(query, &q);
+    if (err != NULL) {
+        fprintf(stderr, "compile failure on %s: %s\n", query, err);
+        exit(1);
+    }
+    failure = dson_query_exec(q, tree, match, &got);
+    err = dson_fetch(tree, query, match, &want);
+    if ((err == NULL) != (failure == NULL)) {
+        fprintf(stderr, "disagree on %s (%d): fetch %s, exec %s\n", query,
+                match, err == NULL ? "passed" : err,
+                failure == NULL ? "passed" : failure);
+        exit(1);
+    } else if (err == NULL && want != got) {
+        fprintf(stderr, "disagree on %s (%d): different values\n", query,
+                match);
+        exit(1);
+    }
+    free(err);
+    dson_query_free(&q);
+}
+
+static void run(const char *name, dson_options *opts) {
+    dson_value *tree;
+    char *err;
+
+    printf("Agreeing on %s...", name);
+    fflush(stdout);
+
+    err = dson_parse_opts(doc, strlen(doc), opts, &tree);
+    if (err != NULL) {
+        fprintf(stderr, "parse failure: %s\n", err);
+        exit(1);
+    }
+    for (size_t i = 0; i < N_QUERIES; i++) {
+        for (uint8_t match = 0; match <= DSON_MATCH_ERROR; match++)
+            agree(tree, queries[i], match);
+    }
+    dson_free(&tree);
+    printf("pass\n");
+}
+
+static void refuse(const char *query) {
+    dson_query *q;
+    char *err;
+
+    printf("Compiling %s...", query);
+    fflush(stdout);
+
+    err = dson_query_compile(query, &q);
+    if (err == NULL) {
+        fprintf(stderr, "unexpected success\n");
+        exit(1);
+    }
+    printf("expected failure: %s\n", err);
+    free(err);
+}
+
+int main() {
+    dson_options opts = { 0 };
+    dson_value *tree, *got;
+    dson_query *q;
+    const char *failure;
+    char *err;
+
+    run("plain", &opts);
+    opts.packed = true;
+    run("packed", &opts);
+    opts.compact = true;
+    opts.inline_strings = true;
+    run("compact", &opts);
+
+    refuse("a");
+    refuse("[0]a");
+    refuse(".a[0]b");
+    refuse("[a]");
+    refuse("[]");
+    refuse("[0");
+    refuse("]");
+
+    printf("Executing with bad arguments...");
+    err = dson_parse(doc, strlen(doc), false, &tree);
+    if (err != NULL) {
+        fprintf(stderr, "parse failure: %s\n", err);
+        exit(1);
+    }
+    err = dson_query_compile(".a", &q);
+    if (err != NULL) {
+        fprintf(stderr, "compile failure: %s\n", err);
+        exit(1);
+    }
+    failure = dson_query_exec(q, tree, DSON_MATCH_ERROR + 1, &got);
+    if (failure == NULL || dson_query_exec(NULL, tree, 0, &got) == NULL ||
+        dson_query_exec(q, NULL, 0, &got) == NULL ||
+        dson_query_exec(q, tree, 0, NULL) == NULL) {
+        fprintf(stderr, "unexpected success\n");
+        exit(1);
+    }
+    printf("expected failure: %s\n", failure);
+    dson_query_free(&q);
+    dson_query_free(&q);
+    dson_free(&tree);
+    return 0;
+}
+
+/* Local variables: */
+/* c-basic-offset: 4 */
+/* indent-tabs-mode: nil */
+/* End: */
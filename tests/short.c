@@ -0,0 +1,152 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+/* such software.  many freedoms. */
+
+#include <cdson.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static char *dump(dson_value *v) {
+    char *err, *out;
+    size_t len;
+
+    err = dson_dump(v, &out, &len);
+    if (err != NULL) {
+        fprintf(stderr, "dump failure: %s\n", err);
+        exit(1);
+    }
+    return out;
+}
+
+static dson_value *parse(const char *in, dson_options *opts) {
+    dson_value *v;
+    char *err;
+
+    err = dson_parse_opts(in, strlen(in), opts, &v);
+    if (err != NULL) {
+        fprintf(stderr, "parse failure: %s\n", err);
+        exit(1);
+    }
+    return v;
+}
+
+static void fetch(dson_value *v, const char *query, uint8_t match_behavior,
+                  const char *expected) {
+    dson_value *got;
+    char *err;
+
+    printf("Fetching %s...", query);
+    fflush(stdout);
+
+    err = dson_fetch(v, query, match_behavior, &got);
+    if (err != NULL) {
+        fprintf(stderr, "fetch failure: %s\n", err);
+        exit(1);
+    } else if (strcmp(dson_str(got), expected) ||
+               dson_str_len(got) != strlen(expected)) {
+        fprintf(stderr, "mismatch - expected \"%s\", got \"%s\"\n", expected,
+                dson_str(got));
+        exit(1);
+    }
+    printf("pass\n");
+}
+
+static void miss(dson_value *v, const char *query, uint8_t match_behavior) {
+    dson_value *got;
+    char *err;
+
+    printf("Fetching %s...", query);
+    fflush(stdout);
+
+    err = dson_fetch(v, query, match_behavior, &got);
+    if (err == NULL) {
+        fprintf(stderr, "unexpected success\n");
+        exit(1);
+    }
+    printf("expected failure: %s\n", err);
+    free(err);
+}
+
+/* a \0 cuts a string short, inline or not */
+static void nul(void) {
+    const char *in = "so \"a\\u000000b\" and \"\\u000000\" many";
+    dson_options opts = { 0 };
+    dson_value *v, *plain;
+
+    printf("Squishing %s (unsafe)...", in);
+    fflush(stdout);
+
+    opts.unsafe = true;
+    plain = parse(in, &opts);
+    opts.inline_strings = true;
+    v = parse(in, &opts);
+    for (size_t i = 0; i < 2; i++) {
+        if (dson_str_len(v->array[i]) != strlen(dson_str(v->array[i])) ||
+            strcmp(dson_str(v->array[i]), plain->array[i]->s)) {
+            fprintf(stderr, "mismatch - expected \"%s\", got \"%s\"\n",
+                    plain->array[i]->s, dson_str(v->array[i]));
+            exit(1);
+        }
+    }
+    dson_free(&v);
+    dson_free(&plain);
+    printf("pass\n");
+}
+
+/* by hand, the old way.  the union is still second */
+static void by_hand(void) {
+    dson_value n = { DSON_DOUBLE, { .n = 5.0 } }, b = { DSON_BOOL, { true } };
+    char *out;
+
+    printf("Dumping values made by hand...");
+    fflush(stdout);
+
+    out = dump(&n);
+    if (strcmp(out, "5")) {
+        fprintf(stderr, "mismatch - expected \"5\", got \"%s\"\n", out);
+        exit(1);
+    }
+    free(out);
+    out = dump(&b);
+    if (strcmp(out, "yes")) {
+        fprintf(stderr, "mismatch - expected \"yes\", got \"%s\"\n", out);
+        exit(1);
+    }
+    free(out);
+    printf("pass\n");
+}
+
+int main() {
+    const char *in = "such \"id\" is \"x1\", \"id\" is \"x2\", \"ident\" is "
+        "\"y\", \"identification\" is \"a good deal longer\" wow";
+    dson_options opts = { 0 };
+    dson_value *v;
+
+    nul();
+    by_hand();
+
+    opts.inline_strings = true;
+    opts.compact = true;
+    v = parse(in, &opts);
+    fetch(v, ".id", DSON_MATCH_FIRST, "x1");
+    fetch(v, ".id", DSON_MATCH_LAST, "x2");
+    fetch(v, ".ident", DSON_MATCH_ERROR, "y");
+    fetch(v, ".identification", DSON_MATCH_ERROR, "a good deal longer");
+    miss(v, ".id", DSON_MATCH_ERROR);
+    miss(v, ".i", DSON_MATCH_FIRST);
+    miss(v, ".identity", DSON_MATCH_FIRST);
+    dson_free(&v);
+
+    /* not asked.  still a pointer, still readable */
+    v = parse(in, NULL);
+    fetch(v, ".ident", DSON_MATCH_FIRST, "y");
+    dson_free(&v);
+    return 0;
+}
+
+/* Local variables: */
+/* c-basic-offset: 4 */
+/* indent-tabs-mode: nil */
+/* End: */
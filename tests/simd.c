@@ -0,0 +1,177 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+/* such software.  many freedoms. */
+
+#include <cdson.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* meson: much skip */
+#define SKIP 77
+
+/* bits that land on block edges.  good and bad */
+static const char *bits[] = {
+    " ", "\t\n  ", "so ", " many", " and ", "\"", "\\n", "\\\"", "\\/",
+    "a", "such ", " is ", " wow", "empty", "\xe3\x82\xa2", "\xc3\xa9",
+    "\xf0\x9f\x90\x95", "\xc0\x80", "\xed\xa0\x80", "\xe2\x80\x8b",
+    "\xef\xbf\xbe", "\x01", "/", "1.5", "yes", "\xff", "\x80",
+    "\xe3\x82",
+};
+#define N_BITS (sizeof(bits) / sizeof(*bits))
+
+static unsigned long seed = 1;
+
+/* such random.  very reproducible */
+static unsigned long roll(unsigned long n) {
+    seed = seed * 6364136223846793005ul + 1442695040888963407ul;
+    return (seed >> 33) % n;
+}
+
+/* what the library makes of in: the error, or the tree dumped */
+static char *outcome(const char *in, size_t len) {
+    dson_value *v;
+    char *err, *out, *res;
+    size_t out_len;
+
+    err = dson_validate(in, len, NULL);
+    if (err != NULL)
+        return err;
+
+    err = dson_parse(in, len, false, &v);
+    if (err != NULL) {
+        fprintf(stderr, "validate passed, parse failed: %s\n", err);
+        exit(1);
+    }
+    err = dson_dump(v, &out, &out_len);
+    dson_free(&v);
+    if (err != NULL)
+        return err;
+
+    res = malloc(out_len + 3);
+    if (res == NULL)
+        exit(1);
+    sprintf(res, "D:%s", out);
+    free(out);
+    return res;
+}
+
+static void force(const char *level) {
+    char *err;
+
+    err = dson_simd_force(level);
+    if (err != NULL) {
+        fprintf(stderr, "can't force %s: %s\n", level, err);
+        exit(1);
+    }
+}
+
+/* level against scalar.  must agree */
+static void agree(const char *level, const char *in, size_t len) {
+    char *want, *got;
+
+    force("scalar");
+    want = outcome(in, len);
+    force(level);
+    got = outcome(in, len);
+
+    if (strcmp(want, got)) {
+        fprintf(stderr, "%s disagrees on %.*s\n  scalar: %s\n  %s: %s\n",
+                level, (int)len, in, want, level, got);
+        exit(1);
+    }
+    free(want);
+    free(got);
+}
+
+/* every offset, every width.  so "....X...." many */
+static void edges(const char *level) {
+    static const char *odd[] = {
+        "\\n", "\xe3\x82\xa2", "\xf0\x9f\x90\x95", "\xed\xa0\x80", "/",
+        "\x01", "\xe2\x80\x8b", "\xe3\x82",
+    };
+    char in[0400];
+    size_t len;
+
+    for (size_t w = 0; w < 0140; w++) {
+        for (size_t at = 0; at <= w; at++) {
+            for (size_t o = 0; o < sizeof(odd) / sizeof(*odd); o++) {
+                len = sprintf(in, "so%*s\"", (int)(w % 041) + 1, "");
+                memset(in + len, 'x', w);
+                memcpy(in + len + at, odd[o], strlen(odd[o]));
+                len += w + strlen(odd[o]);
+                len += sprintf(in + len, "\"%*smany", (int)(w % 043) + 1,
+                               "");
+                agree(level, in, len);
+            }
+        }
+    }
+}
+
+/* bits glued together at random */
+static void jumble(const char *level) {
+    char in[02000];
+    size_t len, n;
+
+    for (int i = 0; i < 020000; i++) {
+        len = 0;
+        n = roll(0100);
+        for (size_t j = 0; j < n; j++) {
+            const char *b = bits[roll(N_BITS)];
+
+            memcpy(in + len, b, strlen(b));
+            len += strlen(b);
+        }
+        agree(level, in, len);
+    }
+}
+
+static int run(const char *level) {
+    char *err;
+
+    printf("Testing %s...", level);
+    fflush(stdout);
+
+    err = dson_simd_force(level);
+    if (err != NULL) {
+        printf("skipped: %s\n", err);
+        free(err);
+        return SKIP;
+    } else if (strcmp(dson_simd(), level)) {
+        fprintf(stderr, "asked for %s, got %s\n", level, dson_simd());
+        exit(1);
+    }
+
+    edges(level);
+    jumble(level);
+    free(dson_simd_force(NULL));
+    printf("pass\n");
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    static const char *levels[] = { "scalar", "sse2", "avx2" };
+    char *err;
+
+    if (argc > 1)
+        return run(argv[1]);
+
+    for (size_t i = 0; i < sizeof(levels) / sizeof(*levels); i++)
+        run(levels[i]);
+
+    printf("Testing a made-up level...");
+    err = dson_simd_force("sse9");
+    if (err == NULL) {
+        fprintf(stderr, "unexpected success\n");
+        exit(1);
+    }
+    printf("expected failure: %s\n", err);
+    free(err);
+    return 0;
+}
+
+/* Local variables: */
+/* c-basic-offset: 4 */
+/* indent-tabs-mode: nil */
+/* End: */
@@ -0,0 +1,241 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+/* such software.  many freedoms. */
+
+#include <cdson.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* "ア".  such filler.  three bytes */
+#define KATA "\xe3\x82\xa2"
+
+static bool banned(unsigned long p) {
+    return p <= 0x9f || p == 0x61c || p == 0x180e ||
+        (p >= 0x2000 && p <= 0x200f) || (p >= 0x2028 && p <= 0x202f) ||
+        (p >= 0x205f && p <= 0x206f) || p == 0x3000 || p == 0xfeff;
+}
+
+static size_t encode(unsigned long p, char *out) {
+    if (p < 0x80) {
+        out[0] = p;
+        return 1;
+    } else if (p < 0x800) {
+        out[0] = 0xc0 | (p >> 6);
+        out[1] = 0x80 | (p & 0x3f);
+        return 2;
+    } else if (p < 0x10000) {
+        out[0] = 0xe0 | (p >> 12);
+        out[1] = 0x80 | ((p >> 6) & 0x3f);
+        out[2] = 0x80 | (p & 0x3f);
+        return 3;
+    }
+    out[0] = 0xf0 | (p >> 18);
+    out[1] = 0x80 | ((p >> 12) & 0x3f);
+    out[2] = 0x80 | ((p >> 6) & 0x3f);
+    out[3] = 0x80 | (p & 0x3f);
+    return 4;
+}
+
+/* slow and sure.  strict UTF-8, minus what DSON refuses */
+static bool reference(const unsigned char *s, size_t len) {
+    unsigned long p;
+    size_t n;
+
+    for (size_t i = 0; i < len; i += n) {
+        if (s[i] < 0x80) {
+            n = 1;
+            continue;
+        } else if (s[i] >= 0xc2 && s[i] <= 0xdf) {
+            n = 2;
+            p = s[i] & 0x1f;
+        } else if (s[i] >= 0xe0 && s[i] <= 0xef) {
+            n = 3;
+            p = s[i] & 0x0f;
+        } else if (s[i] >= 0xf0 && s[i] <= 0xf4) {
+            n = 4;
+            p = s[i] & 0x07;
+        } else {
+            return false;
+        }
+
+        if (i + n > len)
+            return false;
+        for (size_t j = 1; j < n; j++) {
+            if ((s[i + j] & 0xc0) != 0x80)
+                return false;
+            p = p << 6 | (s[i + j] & 0x3f);
+        }
+
+        if ((n == 3 && p < 0x800) || (n == 4 && p < 0x10000) ||
+            p > 0x10ffff || (p >= 0xd800 && p <= 0xdfff) ||
+            p == 0xfffe || p == 0xffff || banned(p))
+            return false;
+    }
+    return true;
+}
+
+/* ア x before, the bytes, ア x after, in quotes */
+static size_t wrap(char *out, size_t before, const char *mid, size_t mid_len,
+                   size_t after) {
+    size_t len = 0;
+
+    out[len++] = '"';
+    for (size_t i = 0; i < before; i++, len += 3)
+        memcpy(out + len, KATA, 3);
+    memcpy(out + len, mid, mid_len);
+    len += mid_len;
+    for (size_t i = 0; i < after; i++, len += 3)
+        memcpy(out + len, KATA, 3);
+    out[len++] = '"';
+    return len;
+}
+
+static void judge(const char *in, size_t len, bool expected,
+                  const char *what) {
+    char *err;
+
+    err = dson_validate(in, len, NULL);
+    if ((err == NULL) != expected) {
+        fprintf(stderr, "%s: expected %s, got %s\n", what,
+                expected ? "success" : "failure", err);
+        exit(1);
+    }
+    free(err);
+}
+
+/* every point, everywhere in a block */
+static void points(void) {
+    char buf[256], mid[4], what[64];
+    unsigned long p;
+    size_t len, n;
+
+    printf("Testing every code point...");
+    fflush(stdout);
+
+    for (p = 0x80; p <= 0x10ffff; p++) {
+        n = encode(p, mid);
+        len = wrap(buf, p % 23, mid, n, 20);
+        snprintf(what, sizeof(what), "U+%04lX", p);
+        judge(buf, len, reference((unsigned char *)mid, n), what);
+    }
+    printf("pass\n");
+}
+
+/* xorshift.  same kibble every run */
+static unsigned long long seed = 88172645463325252ULL;
+static unsigned long long noise(void) {
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    return seed;
+}
+
+/* nice text, one nasty byte */
+static void mangle(size_t rounds) {
+    static const char *pool[] = {
+        "a", " ", KATA, "\xd0\x96", "\xf0\x9f\x90\x95", "\xe4\xb8\xad",
+        "\xc3\xa9", "\xea\xb0\x80",
+    };
+    char buf[256], mid[160], what[64];
+    size_t n, len, at;
+
+    printf("Mangling %zu strings...", rounds);
+    fflush(stdout);
+
+    for (size_t r = 0; r < rounds; r++) {
+        n = 0;
+        while (n < 120) {
+            const char *s = pool[noise() % 8];
+            memcpy(mid + n, s, strlen(s));
+            n += strlen(s);
+        }
+
+        for (int k = noise() % 3; k >= 0; k--) {
+            at = noise() % n;
+            mid[at] = noise();
+            if (mid[at] == '"' || mid[at] == '\\')
+                mid[at] = 'x';
+        }
+
+        len = wrap(buf, noise() % 11, mid, n, noise() % 11);
+        snprintf(what, sizeof(what), "round %zu", r);
+        judge(buf, len, reference((unsigned char *)mid, n), what);
+    }
+    printf("pass\n");
+}
+
+/* what goes in comes out.  controls escaped, junk refused */
+static void dumps(void) {
+    dson_value v = { 0 };
+    char buf[256], mid[5], *out, *err;
+    unsigned long p;
+    size_t n, len;
+
+    printf("Dumping every code point...");
+    fflush(stdout);
+
+    v.type = DSON_STRING;
+    v.s = buf;
+    for (p = 0x80; p <= 0x10ffff; p++) {
+        n = encode(p, mid);
+        mid[n] = '\0';
+        len = wrap(buf, p % 23, mid, n, 20);
+        buf[len - 1] = '\0';
+        v.s = buf + 1;
+
+        err = dson_dump(&v, &out, &len);
+        if (p >= 0xd800 && p <= 0xdfff) {
+            if (err == NULL) {
+                fprintf(stderr, "U+%04lX: surrogate dumped\n", p);
+                exit(1);
+            }
+            free(err);
+            continue;
+        } else if (p == 0xfffe || p == 0xffff) {
+            if (err == NULL) {
+                fprintf(stderr, "U+%04lX: noncharacter dumped\n", p);
+                exit(1);
+            }
+            free(err);
+            continue;
+        } else if (err != NULL) {
+            fprintf(stderr, "U+%04lX: %s\n", p, err);
+            exit(1);
+        } else if ((strstr(out, "\\u") != NULL) != banned(p) ||
+                   (strstr(out, mid) != NULL) == banned(p)) {
+            fprintf(stderr, "U+%04lX: dumped as %s\n", p, out);
+            exit(1);
+        }
+        free(out);
+    }
+    printf("pass\n");
+}
+
+int main() {
+    char buf[256];
+    size_t len;
+
+    points();
+    mangle(200000);
+    dumps();
+
+    printf("Testing overlongs...");
+    len = wrap(buf, 10, "\xc0\xaf", 2, 10);
+    judge(buf, len, false, "C0 AF");
+    len = wrap(buf, 10, "\xe0\x80\xaf", 3, 10);
+    judge(buf, len, false, "E0 80 AF");
+    len = wrap(buf, 10, "\xf0\x80\x80\xaf", 4, 10);
+    judge(buf, len, false, "F0 80 80 AF");
+    len = wrap(buf, 0, "\xc1\xbf", 2, 0);
+    judge(buf, len, false, "C1 BF");
+    printf("pass\n");
+
+    return 0;
+}
+
+/* Local variables: */
+/* c-basic-offset: 4 */
+/* indent-tabs-mode: nil */
+/* End: */
@@ -0,0 +1,81 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+/* such software.  many freedoms. */
+
+#include <cdson.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* validate must agree with parse.  same verdict, same complaint */
+static void judge_opts(const char *in, const dson_options *opts) {
+    dson_value *v;
+    char *parsed, *checked;
+
+    printf("Validating %s...", in);
+    fflush(stdout);
+
+    parsed = dson_parse_opts(in, strlen(in), opts, &v);
+    checked = dson_validate(in, strlen(in), opts);
+    if ((parsed == NULL) != (checked == NULL)) {
+        fprintf(stderr, "disagreement - parse: %s, validate: %s\n", parsed,
+                checked);
+        exit(1);
+    } else if (parsed != NULL && strcmp(parsed, checked)) {
+        fprintf(stderr, "mismatch - expected \"%s\", got \"%s\"\n", parsed,
+                checked);
+        exit(1);
+    }
+
+    if (checked != NULL)
+        printf("expected failure: %s\n", checked);
+    else
+        printf("pass\n");
+
+    free(parsed);
+    free(checked);
+    if (parsed == NULL)
+        dson_free(&v);
+}
+
+static void judge(const char *in, bool unsafe) {
+    dson_options opts = { 0 };
+
+    opts.unsafe = unsafe;
+    judge_opts(in, &opts);
+}
+
+int main() {
+    dson_options opts = { 0 };
+
+    judge("empty", false);
+    judge("so 1 and 2.4very-3 also -5 many", false);
+    judge("such \"doge\" is so yes and no many, \"shibe\" is such wow wow",
+          false);
+    judge("such \"a\\nb\\\"c\" is \"\xe3\x82\xb7\xe3\x83\x90\" wow", false);
+    judge("\"\\u000101\"", true);
+    judge("\"\\u000101\"", false);
+    judge("\"\\u000041\"", true);
+    judge("\"\x01\"", false);
+    judge("\"\xc3\x28\"", false);
+    judge("so 1 and 2 also", false);
+    judge("such \"a\" is yes wow wow", false);
+    judge("so so so many many", false);
+    judge("such \"a\" was empty wow", false);
+    judge("so 8 many", false);
+    judge("", false);
+
+    /* much nesting.  same limit */
+    opts.max_depth = 2;
+    judge_opts("so so many many", &opts);
+    judge_opts("so such \"a\" is so many wow many", &opts);
+    judge_opts("so so so many many many", &opts);
+
+    return 0;
+}
+
+/* Local variables: */
+/* c-basic-offset: 4 */
+/* indent-tabs-mode: nil */
+/* End: */